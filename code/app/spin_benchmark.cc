@@ -0,0 +1,143 @@
+// EPOS Spin Lock Microbenchmark
+
+// Compares the spin lock algorithms (see utility/spin.h) on 2, 4 and 8 CPUs. One thread per CPU
+// repeatedly acquires the same lock, updates a shared counter and releases it for a fixed time.
+// Latencies are measured from the call to acquire() to its return, in TSC ticks. Fairness is
+// Jain's index over the number of acquisitions of each CPU, in thousandths (1000 = all equal).
+
+#include <utility/ostream.h>
+#include <utility/spin.h>
+#include <machine.h>
+#include <thread.h>
+#include <tsc.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Build>::CPUS;
+const unsigned int DURATION = 200; // ms per run
+const int CRITICAL = 100;   // iterations inside the critical section
+const int OUTSIDE = 200;    // iterations between releasing and acquiring again
+
+struct Statistics
+{
+    unsigned long long acquisitions;
+    unsigned long long latency;
+    unsigned long long max;
+};
+
+OStream cout;
+
+Statistics stats[CPUS];
+volatile unsigned int ready;
+volatile bool go;
+volatile TSC::Time_Stamp deadline;
+volatile unsigned int shared;
+
+TAS_Spin tas;
+Ticket_Spin ticket;
+MCS_Spin mcs;
+Recursive_TAS_Spin recursive_tas;
+Recursive_Spin<Ticket_Spin> recursive_ticket;
+Recursive_Spin<MCS_Spin> recursive_mcs;
+
+template<typename Lock>
+int contender(Lock * lock, unsigned int n, unsigned int cpu);
+
+template<typename Lock>
+void run(const char * name, Lock * lock);
+
+int main()
+{
+    cout << "Spin lock microbenchmark (" << Machine::n_cpus() << " CPUs, " << DURATION << " ms per run, latencies in TSC ticks at " << TSC::frequency() << " Hz)" << endl;
+
+    run("TAS", &tas);
+    run("Ticket", &ticket);
+    run("MCS", &mcs);
+    run("Recursive TAS", &recursive_tas);
+    run("Recursive Ticket", &recursive_ticket);
+    run("Recursive MCS", &recursive_mcs);
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
+
+template<typename Lock>
+void run(const char * name, Lock * lock)
+{
+    for(unsigned int n = 2; n <= CPUS; n *= 2) {
+        if(n > Machine::n_cpus())
+            break;
+
+        for(unsigned int i = 0; i < n; i++)
+            stats[i].acquisitions = stats[i].latency = stats[i].max = 0;
+        ready = 0;
+        go = false;
+
+        // The contender on CPU 0 only runs once main() blocks on join()
+        Thread * contenders[CPUS];
+        for(unsigned int i = 0; i < n; i++)
+            contenders[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, i)), &contender<Lock>, lock, n, i);
+        for(unsigned int i = 0; i < n; i++) {
+            contenders[i]->join();
+            delete contenders[i];
+        }
+
+        unsigned long long total = 0;
+        unsigned long long squares = 0;
+        unsigned long long latency = 0;
+        unsigned long long max = 0;
+        unsigned long long min_cpu = stats[0].acquisitions;
+        unsigned long long max_cpu = stats[0].acquisitions;
+        for(unsigned int i = 0; i < n; i++) {
+            total += stats[i].acquisitions;
+            squares += stats[i].acquisitions * stats[i].acquisitions;
+            latency += stats[i].latency;
+            if(stats[i].max > max)
+                max = stats[i].max;
+            if(stats[i].acquisitions < min_cpu)
+                min_cpu = stats[i].acquisitions;
+            if(stats[i].acquisitions > max_cpu)
+                max_cpu = stats[i].acquisitions;
+        }
+
+        cout << name << " on " << n << " CPUs: acquisitions=" << total << " (min=" << min_cpu << ",max=" << max_cpu << " per CPU)"
+             << " latency={avg=" << (total ? latency / total : 0) << ",max=" << max << "}"
+             << " fairness=" << (squares ? 1000 * total * total / (n * squares) : 0) << endl;
+    }
+}
+
+template<typename Lock>
+int contender(Lock * lock, unsigned int n, unsigned int cpu)
+{
+    Statistics & s = stats[cpu];
+
+    CPU::finc(ready);
+    if(cpu == 0) {
+        while(ready < n);
+        deadline = TSC::time_stamp() + DURATION * (TSC::frequency() / 1000);
+        go = true;
+    } else
+        while(!go);
+
+    // Interrupts are disabled around the lock as the kernel does (and MCS requires)
+    while(TSC::time_stamp() < deadline) {
+        CPU::int_disable();
+        TSC::Time_Stamp begin = TSC::time_stamp();
+        lock->acquire();
+        TSC::Time_Stamp latency = TSC::time_stamp() - begin;
+        for(int i = 0; i < CRITICAL; i++)
+            shared = shared + 1;
+        lock->release();
+        CPU::int_enable();
+
+        s.acquisitions++;
+        s.latency += latency;
+        if(latency > s.max)
+            s.max = latency;
+
+        for(volatile int i = 0; i < OUTSIDE; i++);
+    }
+
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include <clock.h>
 #include <machine/pc/rtc.h>
 #include <alarm.h>
+#include <trace.h>
 
 //#include <perf_mon.h>
 
@@ -57,30 +58,10 @@ int main()
 
         for(int i = 0; i < 8; i++)
             delete cons[i];
-/*
-        Thread::_fim = true;
-
-        cout << "\n\n\n\n\n TEMPERATURA:" << endl;
-        for (int i = 0; i < Machine::n_cpus(); i++) {
-            cout << "\n\n\n\n\ntempCPU" << i << endl; 
-            for (int j = 0; j < Thread::_tempPos[i]; j++)
-                    cout <<Thread::_graficoTemp[i][j] << endl;
-        }
 
-        cout << "\n\n\n\n\n INSTRUCTIONS RETIRED:" << endl;
-        for (int i = 0; i < Machine::n_cpus(); i++) {
-            cout << "\n\n\n\n\ninstCPU" << i << endl; 
-            for (int j = 0; j < Thread::_tempPos[i]; j++)
-                    cout <<Thread::_graficoInst[i][j] << endl;
-        }
+        // Decode with tools/epostrace
+        Trace::dump(cout);
 
-        cout << "\n\n\n\n\n LLC MISS:" << endl;
-        for (int i = 0; i < Machine::n_cpus(); i++) {
-            cout << "\n\n\n\n\nllcCPU" << i << endl; 
-            for (int j = 0; j < Thread::_tempPos[i]; j++)
-                    cout <<Thread::_graficoMiss[i][j] << endl;
-        }
-*/
     return 0;
 }
 
@@ -15,6 +15,12 @@ struct Traits
     typedef TLIST<> ASPECTS;
 };
 
+__END_SYS
+
+#include <system/traits_defaults.h>
+
+__BEGIN_SYS
+
 template<> struct Traits<Build>
 {
     enum {LIBRARY, BUILTIN, KERNEL};
@@ -48,7 +54,7 @@ template<> struct Traits<Lists>: public Traits<void>
     static const bool debugged = hysterically_debugged;
 };
 
-template<> struct Traits<Spin>: public Traits<void>
+template<> struct Traits<Spin>: public Default_Traits<Spin>
 {
     static const bool debugged = hysterically_debugged;
 };
@@ -122,7 +128,7 @@ template<> struct Traits<Task>: public Traits<void>
     static const bool enabled = Traits<System>::multitask;
 };
 
-template<> struct Traits<Thread>: public Traits<void>
+template<> struct Traits<Thread>: public Default_Traits<Thread>
 {
     static const bool smp = Traits<System>::multicore;
 
@@ -130,14 +136,24 @@ template<> struct Traits<Thread>: public Traits<void>
     static const unsigned int QUANTUM = 10000; // us
 
     static const bool trace_idle = hysterically_debugged;
+    static const bool monitored = true; // per-thread PMU counts (see Thread::counters())
+};
+
+template<> struct Traits<DVFS>: public Default_Traits<DVFS>
+{
+};
+
+template<> struct Traits<Trace>: public Default_Traits<Trace>
+{
+    static const bool enabled = true;
 };
 
-template<> struct Traits<Scheduler<Thread> >: public Traits<void>
+template<> struct Traits<Scheduler<Thread> >: public Default_Traits<Scheduler<Thread> >
 {
     static const bool debugged = Traits<Thread>::trace_idle || hysterically_debugged;
 };
 
-template<> struct Traits<Periodic_Thread>: public Traits<void>
+template<> struct Traits<Periodic_Thread>: public Default_Traits<Periodic_Thread>
 {
     static const bool simulate_capacity = false;
 };
@@ -157,7 +173,7 @@ template<> struct Traits<Alarm>: public Traits<void>
     static const bool visible = hysterically_debugged;
 };
 
-template<> struct Traits<Synchronizer>: public Traits<void>
+template<> struct Traits<Synchronizer>: public Default_Traits<Synchronizer>
 {
     static const bool enabled = Traits<System>::multithread;
 };
@@ -3,7 +3,7 @@
 #ifndef __alarm_h
 #define __alarm_h
 
-#include <utility/queue.h>
+#include <utility/list.h>
 #include <utility/handler.h>
 #include <tsc.h>
 #include <rtc.h>
@@ -16,26 +16,45 @@ __BEGIN_SYS
 class Alarm
 {
     friend class System;
+    friend class Thread;
     friend class Alarm_Chronometer;
     friend class Periodic_Thread;
     friend class RT_Thread;
+    friend class Inheritance_Mutex;
     friend class Scheduling_Criteria::FCFS;
     friend class Scheduling_Criteria::EDF;
 
 private:
     typedef TSC::Hertz Hertz;
+    typedef TSC::Time_Stamp Time_Stamp;
     typedef Timer::Tick Tick;
 
-    typedef Relative_Queue<Alarm, Tick> Queue;
+    typedef Timing_Wheel<Alarm, Tick> Queue;
+    typedef Ordered_List<Alarm, Time_Stamp> Precise_Queue; // ranked by TSC deadline
+
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
 
 public:
     typedef RTC::Microsecond Microsecond;
+    typedef RTC::Nanosecond Nanosecond;
 
     // Infinite times (for alarms)
     enum { INFINITE = RTC::INFINITE };
 
+    // Any CPU (for alarms), meaning the creator's
+    enum { ANY = -1 };
+
 public:
-    Alarm(const Microsecond & time, Handler * handler, int times = 1);
+    // Each CPU handles the alarms in its own queue with its local timer, so an alarm armed on the
+    // CPU of the thread it wakes up (e.g. by a pinned thread) does not need cross-CPU wakeups
+    Alarm(const Microsecond & time, Handler * handler, int times = 1, int cpu = ANY);
+
+    // High-resolution alarms are not rounded to ticks: they are kept apart, ordered by TSC deadline, and fired by
+    // a one-shot of the local timer within the tick they fall in (see Timer::precise()). Periodic ones are
+    // re-armed from their previous deadline, so they do not drift. Without Timer::high_resolution, they are
+    // ordinary alarms. Requests for other CPUs are only armed at their next tick.
+    Alarm(const Nanosecond & time, Handler * handler, int times = 1, int cpu = ANY);
+
     ~Alarm();
 
     const Microsecond & period() const { return _time; }
@@ -44,6 +63,7 @@ public:
     static Hertz frequency() { return _timer->frequency(); }
 
     static void delay(const Microsecond & time);
+    static void delay(const Nanosecond & time);
 
 private:
     static void init();
@@ -56,21 +76,51 @@ private:
         return (time + timer_period() / 2) / timer_period();
     }
 
-    static void lock() { Thread::lock(); }
-    static void unlock() { Thread::unlock(); }
+    static Time_Stamp cycles(const Nanosecond & time) {
+        Time_Stamp per_us = TSC::frequency() / 1000000;
+        return time / 1000 * per_us + time % 1000 * per_us / 1000;
+    }
+
+    void start();
+
+    // Each request queue has a lock of its own, independent of Thread's scheduler locks
+    static void lock(unsigned int cpu) {
+        CPU::int_disable();
+        if(Traits<System>::multicore)
+            _lock[cpu].acquire();
+    }
+
+    static void unlock(unsigned int cpu) {
+        if(Traits<System>::multicore)
+            _lock[cpu].release();
+        CPU::int_enable();
+    }
+
+    // Ticks until the next request of the current CPU is due (for tickless idle, see Timer::halt())
+    static Tick next();
 
     static void handler(const IC::Interrupt_Id & i);
 
+    // High-resolution requests of "cpu" due by now, with its lock held
+    static void dispatch(unsigned int cpu);
+    static void precise_handler(const IC::Interrupt_Id & i);
+
 private:
     Microsecond _time;
     Handler * _handler;
     int _times;
     Tick _ticks;
+    unsigned int _cpu;
+    Time_Stamp _interval;                   // in TSC cycles, 0 for tick-based alarms
     Queue::Element _link;
+    Precise_Queue::Element _precise_link;   // ranked 0 while not queued
 
     static Alarm_Timer * _timer;
-    static volatile Tick _elapsed;
-    static Queue _request;
+    static Precise_Timer * _precise_timer;
+    static volatile Tick _elapsed; // counted by CPU 0
+    static Queue _request[CPUS];
+    static Precise_Queue _precise[CPUS];
+    static Simple_Spin _lock[CPUS];
 };
 
 
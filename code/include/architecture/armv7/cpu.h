@@ -349,6 +349,9 @@ public:
         return old;
    }
 
+    // Orders the memory accesses before it with respect to those after it, as seen by other CPUs
+    static void barrier() { ASM("dmb" : : : "memory"); }
+
     static Reg32 htonl(Reg32 v) { return swap32(v); }
     static Reg16 htons(Reg16 v) { return swap16(v); }
     static Reg32 ntohl(Reg32 v) { return swap32(v); }
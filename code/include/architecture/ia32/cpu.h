@@ -93,6 +93,29 @@ public:
         CR4_PSE     = 1 << 8    // CR4 Performance Counter Enable
     };
 
+    // Power Management MSRs
+    enum {
+        IA32_MPERF              = 0x0e7,
+        IA32_APERF              = 0x0e8,
+        MSR_PLATFORM_INFO       = 0x0ce,
+        IA32_PERF_STATUS        = 0x198,
+        IA32_PERF_CTL           = 0x199,
+        IA32_CLOCK_MODULATION   = 0x19a,
+        IA32_MISC_ENABLE        = 0x1a0
+    };
+
+    // Power Management Flags
+    enum {
+        CPUID_EIST              = 1 << 7,       // CPUID(1).ECX: Enhanced Intel SpeedStep Technology
+        CPUID_APERFMPERF        = 1 << 0,       // CPUID(6).ECX: IA32_APERF and IA32_MPERF
+        MISC_ENABLE_EIST        = 1 << 16,      // IA32_MISC_ENABLE: enable P-state transitions
+        CLOCK_MODULATION_ON     = 1 << 4,       // IA32_CLOCK_MODULATION: on-demand modulation enable
+        CLOCK_MODULATION_DUTY   = 0xf           // IA32_CLOCK_MODULATION: duty cycle, in 1/16 steps
+    };
+
+    // P-states are multiples (ratios) of the bus reference clock
+    typedef unsigned int Ratio;
+
     // Segment Flags
     enum {
         SEG_ACC         = 0x01,
@@ -312,7 +335,7 @@ public:
     static Hertz clock() { return _cpu_clock; }
     
     static void clock(Hertz new_clock) {
-    	Reg32 clockm_addr = 0x19a;
+    	Reg32 clockm_addr = IA32_CLOCK_MODULATION;
     	float fator;
 		if (new_clock <= _cpu_clock * 0.0625) {
 			fator = 0.0625;
@@ -336,6 +359,42 @@ public:
     
     static Hertz bus_clock() { return _bus_clock; }
 
+    // Unified frequency interface: P-states (IA32_PERF_CTL) scale voltage and frequency,
+    // while clock(Hertz) above only duty-cycles the core (T-states)
+    static Hertz frequency() {
+        Hertz f = _max_ratio ? ratio2clock(ratio()) : _cpu_clock;
+        Reg64 modulation = rdmsr(IA32_CLOCK_MODULATION);
+        if(modulation & CLOCK_MODULATION_ON)
+            f = static_cast<Reg64>(f) * (modulation & CLOCK_MODULATION_DUTY) / 16;
+        return f;
+    }
+
+    static void frequency(const Ratio & r) {
+        if(!_max_ratio)
+            return;
+        Ratio ratio = (r > _max_ratio) ? _max_ratio : (r < _min_ratio) ? _min_ratio : r;
+        wrmsr(IA32_PERF_CTL, (rdmsr(IA32_PERF_CTL) & ~0xff00ULL) | (ratio << 8));
+    }
+
+    // Effective frequency feedback: while the core is not halted, IA32_MPERF counts at the nominal clock and
+    // IA32_APERF at the delivered one, so the ratio of their increments is the speed relative to clock()
+    static bool effective() { return _effective; } // false if the counters are not available (both read 0)
+    static Reg64 aperf() { return _effective ? rdmsr(IA32_APERF) : 0; }
+    static Reg64 mperf() { return _effective ? rdmsr(IA32_MPERF) : 0; }
+
+    static Ratio ratio() { return _max_ratio ? (rdmsr(IA32_PERF_STATUS) >> 8) & 0xff : 0; }
+    static Ratio min_ratio() { return _min_ratio; }
+    static Ratio max_ratio() { return _max_ratio; } // 0 if P-states are not available
+
+    // The nominal clock corresponds to the maximum non-turbo ratio
+    static Hertz ratio2clock(const Ratio & r) { return _max_ratio ? static_cast<Reg64>(_cpu_clock) * r / _max_ratio : _cpu_clock; }
+    static Ratio clock2ratio(const Hertz & f) { // highest ratio not above f
+        if(!_max_ratio)
+            return 0;
+        Ratio r = static_cast<Reg64>(f) * _max_ratio / _cpu_clock;
+        return (r > _max_ratio) ? _max_ratio : (r < _min_ratio) ? _min_ratio : r;
+    }
+
     static void int_enable() { ASM("sti"); }
     static void int_disable() { ASM("cli"); }
     static bool int_enabled() { return (flags() & FLAG_IF); }
@@ -389,6 +448,11 @@ public:
         return compare;
    }
 
+    // Compiler-only barrier: keeps the compiler from moving memory accesses across it, but emits no fence
+    // IA32 already keeps loads ordered with loads and stores with stores (e.g. for Seqlock), but might let a later
+    // load pass an earlier store, which this doesn't prevent (a locked instruction, such as cas(), does)
+    static void barrier() { ASM("" : : : "memory"); }
+
     static Reg32 htonl(Reg32 v) { ASM("bswap %0" : "=r"(v) : "0"(v), "r"(v)); return v; }
     static Reg16 htons(Reg16 v) { return swap16(v); }
     static Reg32 ntohl(Reg32 v) { return htonl(v); }
@@ -629,6 +693,9 @@ private:
 private:
     static unsigned int _cpu_clock;
     static unsigned int _bus_clock;
+    static Ratio _min_ratio;
+    static Ratio _max_ratio;
+    static bool _effective;
 };
 
 inline CPU::Reg32 htonl(CPU::Reg32 v) { return CPU::htonl(v); }
@@ -6,6 +6,7 @@
 #include <tsc.h>
 #include <rtc.h>
 #include <alarm.h>
+#include <thread.h>
 
 __BEGIN_SYS
 
@@ -82,6 +83,48 @@ private:
     Time_Stamp _stop;
 };
 
+// Measures the work of the running thread in microseconds of the nominal clock (see Thread::consumed()),
+// so measures taken while DVFS slows the CPU down are comparable to capacities and to full-speed ones
+// Requires Traits<Thread>::monitored
+class Invariant_Chronometer
+{
+private:
+    typedef unsigned long long Time_Stamp;
+
+public:
+    typedef TSC::Hertz Hertz;
+    typedef RTC::Microsecond Microsecond;
+
+public:
+    Invariant_Chronometer() : _start(0), _stop(0), _running(false), _stopped(false) {}
+
+    Hertz frequency() { return CPU::clock(); }
+
+    void reset() { _start = 0; _stop = 0; _running = false; _stopped = false; }
+    void start() { if(!_running) { _start = work(); _running = true; } }
+    void lap() { if(_running) { _stop = work(); _stopped = true; } }
+    void stop() { lap(); }
+
+    Microsecond read() { return ticks() * 1000000 / frequency(); }
+
+private:
+    static Time_Stamp work() { return Thread::self()->counters().cycles; }
+
+    Time_Stamp ticks() {
+        if(!_running)
+            return 0;
+        if(!_stopped)
+            return work() - _start;
+        return _stop - _start;
+    }
+
+private:
+    Time_Stamp _start;
+    Time_Stamp _stop;
+    bool _running;
+    bool _stopped;
+};
+
 class Chronometer: public IF<Traits<TSC>::enabled && !Traits<System>::multicore, TSC_Chronometer, Alarm_Chronometer>::Result {};
 
 __END_SYS
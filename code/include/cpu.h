@@ -103,6 +103,8 @@ public:
         return old;
     }
 
+    static void barrier() { ASM("" : : : "memory"); }
+
     static Reg32 htonl(Reg32 v) { return (BIG_ENDIAN) ? v : swap32(v); }
     static Reg16 htons(Reg16 v) { return (BIG_ENDIAN) ? v : swap16(v); }
     static Reg32 ntohl(Reg32 v) { return htonl(v); }
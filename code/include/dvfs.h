@@ -0,0 +1,354 @@
+// EPOS DVFS Governor Component Declarations
+
+// The governor runs periodically on every CPU from its own timer channel
+// (see DVFS_Timer), sampling the core's temperature and performance counters
+// and deciding its clock. The decision is cached per CPU, so the dispatch path
+// of Thread never touches MSRs nor waits for them with the scheduler lock held.
+// The decision itself is delegated to the policy selected by Traits<DVFS>::Governor.
+// Decisions are applied preferably through P-states, which also lower the
+// voltage; clock modulation (T-states) is only used below the lowest P-state.
+// Since P-states and T-states are private to each core, the clock of another
+// CPU is changed by posting a request and sending it an INT_FREQUENCY IPI.
+// With criteria that keep one queue per CPU, heat can also be spread by moving
+// READY threads from the hottest to the coolest core (see Thermal_Balancer).
+
+#ifndef __dvfs_h
+#define __dvfs_h
+
+#include <cpu.h>
+#include <ic.h>
+#include <pmu.h>
+#include <tsc.h>
+#include <timer.h>
+#include <machine.h>
+#include <scheduler.h>
+#include <trace.h>
+#include <architecture/ia32/thermal.h>
+
+__BEGIN_SYS
+
+template<typename> class Queue_Migrator;
+
+// All governors must define "Hertz decide(const Sample & s)" returning the
+// clock the CPU that produced the sample should run at. One instance is kept
+// per CPU, so governors can keep per-core state between samples.
+// Governors that set "per_thread" are also consulted at each context switch,
+// after classifying the phase of the thread leaving the CPU with "classify()".
+namespace DVFS_Governors
+{
+    typedef CPU::Hertz Hertz;
+    typedef PMU::Count Count;
+
+    // Per-CPU observations taken at each DVFS period (and, for per-thread governors, at each context switch)
+    struct Sample
+    {
+        unsigned int temperature;       // Celsius
+        Percent load;                   // busy time since the previous sample (see Thread::idle())
+        Hertz clock;                    // current clock
+        Count instructions;             // PMU counts since the previous sample
+        Count cycles;
+        Count llc_misses;
+        unsigned int phase;             // of the thread about to run (see classify())
+    };
+
+    class Governor_Common
+    {
+    protected:
+        // Clock modulation cannot go below 1/16 of the lowest P-state
+        static const unsigned int MIN_CLOCK_FRACTION = 16;
+
+    public:
+        static const bool per_thread = false;
+
+        // Thread phases
+        enum {
+            UNKNOWN = 0,
+            COMPUTE_BOUND,
+            MEMORY_BOUND
+        };
+
+    protected:
+        Governor_Common() {}
+
+    public:
+        static Hertz max_clock() { return CPU::clock(); }
+        static Hertz min_clock() { return CPU::ratio2clock(CPU::min_ratio()) / MIN_CLOCK_FRACTION; }
+
+        unsigned int classify(const Sample & s, unsigned int phase) { return phase; }
+
+    protected:
+        static Hertz clamp(unsigned long long clock) {
+            return (clock > max_clock()) ? max_clock() : (clock < min_clock()) ? min_clock() : clock;
+        }
+    };
+
+    // Bang-bang controller: throttles at MAX_TEMPERATURE until the core cools down to MIN_TEMPERATURE
+    class Hysteresis: public Governor_Common
+    {
+    public:
+        static const unsigned int MAX_TEMPERATURE = Traits<DVFS>::MAX_TEMPERATURE;
+        static const unsigned int MIN_TEMPERATURE = Traits<DVFS>::MIN_TEMPERATURE;
+        static const Hertz THROTTLED_CLOCK = Traits<DVFS>::THROTTLED_CLOCK;
+
+    public:
+        Hysteresis(): _throttled(false) {}
+
+        Hertz decide(const Sample & s) {
+            if(s.temperature >= MAX_TEMPERATURE)
+                _throttled = true;
+            else if(s.temperature <= MIN_TEMPERATURE)
+                _throttled = false;
+
+            return _throttled ? clamp(THROTTLED_CLOCK) : max_clock();
+        }
+
+    private:
+        bool _throttled;
+    };
+
+    // Thermal PID controller: the output is the clock reduction (in per-mille of the nominal clock)
+    // needed to keep the core at TARGET_TEMPERATURE
+    class PID: public Governor_Common
+    {
+    public:
+        static const int TARGET_TEMPERATURE = Traits<DVFS>::TARGET_TEMPERATURE;
+        static const int KP = Traits<DVFS>::KP;
+        static const int KI = Traits<DVFS>::KI;
+        static const int KD = Traits<DVFS>::KD;
+
+    private:
+        static const int SCALE = 1000;
+        static const int MAX_OUTPUT = SCALE - SCALE / MIN_CLOCK_FRACTION;
+
+    public:
+        PID(): _integral(0), _error(0) {}
+
+        Hertz decide(const Sample & s) {
+            int error = static_cast<int>(s.temperature) - TARGET_TEMPERATURE;
+
+            // Anti-windup: the integral term alone never exceeds the output range
+            _integral += error;
+            if(KI) {
+                if(_integral * KI > MAX_OUTPUT)
+                    _integral = MAX_OUTPUT / KI;
+                else if(_integral < 0)
+                    _integral = 0;
+            }
+
+            int output = KP * error + KI * _integral + KD * (error - _error);
+            _error = error;
+
+            if(output < 0)
+                output = 0;
+            else if(output > MAX_OUTPUT)
+                output = MAX_OUTPUT;
+
+            return clamp(static_cast<unsigned long long>(max_clock()) * (SCALE - output) / SCALE);
+        }
+
+    private:
+        int _integral;
+        int _error;
+    };
+
+    // Utilization-driven controller (after Linux's ondemand): jumps to the nominal clock when the core is busy
+    // and scales it down, proportionally to the load, when the core is mostly idle
+    class Ondemand: public Governor_Common
+    {
+    public:
+        static const unsigned int UP_THRESHOLD = Traits<DVFS>::UP_THRESHOLD;
+        static const unsigned int DOWN_THRESHOLD = Traits<DVFS>::DOWN_THRESHOLD;
+
+    public:
+        Ondemand() {}
+
+        Hertz decide(const Sample & s) {
+            if(s.load >= UP_THRESHOLD)
+                return max_clock();
+
+            if(s.load <= DOWN_THRESHOLD) // lowest clock that keeps the load under UP_THRESHOLD
+                return clamp(static_cast<unsigned long long>(s.clock) * s.load / UP_THRESHOLD);
+
+            return s.clock;
+        }
+    };
+
+    // PMU-driven controller: threads with many LLC misses per kilo-instruction (MPKI) and few instructions per cycle
+    // (IPC) are memory bound, so they run at MEMORY_BOUND_CLOCK, since the core mostly waits on memory anyway, while
+    // compute-bound threads run at the nominal clock. Threads are classified over each quantum and their phase is kept
+    // in Thread, so the clock follows them across CPUs. The thermal protection of Hysteresis still applies on top.
+    class Memory_Aware: public Hysteresis
+    {
+    public:
+        static const bool per_thread = true;
+
+        static const unsigned int MPKI_THRESHOLD = Traits<DVFS>::MPKI_THRESHOLD;
+        static const unsigned int IPC_THRESHOLD = Traits<DVFS>::IPC_THRESHOLD;         // per-mille
+        static const unsigned int MEMORY_BOUND_CLOCK = Traits<DVFS>::MEMORY_BOUND_CLOCK; // percentage of the nominal clock
+
+    private:
+        // Quanta shorter than this say little about a thread
+        static const unsigned int MIN_INSTRUCTIONS = 100000;
+
+    public:
+        Memory_Aware() {}
+
+        unsigned int classify(const Sample & s, unsigned int phase) {
+            if((s.instructions < MIN_INSTRUCTIONS) || !s.cycles)
+                return phase;
+
+            Count mpki = s.llc_misses * 1000 / s.instructions;
+            Count ipc = s.instructions * 1000 / s.cycles;
+
+            return ((mpki >= MPKI_THRESHOLD) && (ipc < IPC_THRESHOLD)) ? MEMORY_BOUND : COMPUTE_BOUND;
+        }
+
+        Hertz decide(const Sample & s) {
+            Hertz thermal = Hysteresis::decide(s);
+            Hertz phase = (s.phase == MEMORY_BOUND) ? clamp(static_cast<unsigned long long>(max_clock()) * MEMORY_BOUND_CLOCK / 100) : max_clock();
+
+            return (thermal < phase) ? thermal : phase;
+        }
+    };
+};
+
+
+// Thermal migration
+// Invoked by the governor of CPU 0, it moves the first movable READY thread of the hottest CPU's queue to
+// the coolest CPU's one (see Queue_Migrator), as long as the temperature gap is significant. At most one thread is moved per
+// MIGRATION_INTERVAL, so threads do not bounce among cores faster than they can heat them up.
+template<typename T>
+class Thermal_Balancer
+{
+private:
+    static const unsigned int TEMPERATURE = Traits<DVFS>::MIGRATION_TEMPERATURE;
+    static const unsigned int DELTA = Traits<DVFS>::MIGRATION_DELTA;
+    static const unsigned int INTERVAL = Traits<DVFS>::MIGRATION_INTERVAL / Traits<Thread>::DVFS_PERIOD; // DVFS periods
+
+public:
+    static void balance(const volatile unsigned int * temperature) {
+        if(_cooldown) {
+            _cooldown--;
+            return;
+        }
+
+        unsigned int hot = 0;
+        unsigned int cool = 0;
+        for(unsigned int i = 1; i < Machine::n_cpus(); i++) {
+            if(temperature[i] > temperature[hot])
+                hot = i;
+            if(temperature[i] < temperature[cool])
+                cool = i;
+        }
+
+        if((temperature[hot] < TEMPERATURE) || (temperature[hot] - temperature[cool] < DELTA))
+            return;
+
+        T::lock(hot, cool);
+
+        T * t = Queue_Migrator<T>::move(hot, cool);
+        if(t) {
+            T::release(hot);
+
+            db<DVFS>(INF) << "Thermal_Balancer::balance(): " << t << " moved from CPU " << hot << " (" << temperature[hot] << " C) to CPU " << cool << " (" << temperature[cool] << " C)" << endl;
+
+            _cooldown = INTERVAL;
+            Trace::record(Trace::MIGRATION, t);
+            T::reschedule(cool);
+        } else
+            T::unlock(hot, cool);
+    }
+
+private:
+    static unsigned int _cooldown;
+};
+
+template<typename T>
+unsigned int Thermal_Balancer<T>::_cooldown;
+
+class No_Thermal_Balancer
+{
+public:
+    static void balance(const volatile unsigned int * temperature) {}
+};
+
+
+class DVFS
+{
+    friend class System;
+    friend class Init_System;
+    friend class Thread;
+
+private:
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
+
+    typedef TSC::Time_Stamp Time_Stamp;
+    typedef DVFS_Governors::Sample Sample;
+
+public:
+    typedef CPU::Hertz Hertz;
+    typedef Timer::Microsecond Microsecond;
+    typedef Traits<DVFS>::Governor Governor;
+    typedef IF<Traits<DVFS>::migration && Traits<Thread>::Criterion::migratable && (Traits<Machine>::CPUS > 1), Thermal_Balancer<Thread>, No_Thermal_Balancer>::Result Balancer;
+
+    static const bool enabled = Traits<DVFS>::enabled && Traits<Thread>::Criterion::energy_aware;
+    static const unsigned int PERIOD = Traits<Thread>::DVFS_PERIOD;
+    static const bool per_thread = enabled && Governor::per_thread;
+
+    // PMU channels used to collect statistics
+    // CYCLES counts core cycles, which advance at the core's current clock, so instructions per cycle don't drop
+    // just because the clock does (reference cycles, PMU::DVS_CLOCK, tick at the nominal rate whatever the clock)
+    enum {
+        INSTRUCTIONS    = 3,
+        LLC_MISSES      = 4,
+        CYCLES          = 5
+    };
+
+public:
+    DVFS() {}
+
+    static unsigned int temperature(unsigned int cpu) { return _cpu_temperature[cpu]; }
+    static Hertz clock(unsigned int cpu) { return _cpu_clock[cpu]; }
+    static void clock(unsigned int cpu, const Hertz & clock);
+
+    // Clock actually delivered to "cpu" over the last governor period, as measured with IA32_APERF/IA32_MPERF,
+    // which also reflects turbo and thermal throttling (the requested clock if the counters are not available)
+    static Hertz effective_clock(unsigned int cpu) { return _effective_clock[cpu]; }
+
+private:
+    static void init();
+    static void monitor();
+
+    static Percent load(unsigned int cpu);
+    static void measure(unsigned int cpu);
+    static void scale(const Hertz & clock);
+    static void apply(unsigned int cpu);
+
+    static void account(unsigned int cpu, Sample * sample, Thread * thread);
+    static bool decide(unsigned int cpu, const Sample & sample);
+
+    static void governor(const IC::Interrupt_Id & i);
+    static void dispatch(Thread * prev, Thread * next);
+    static void frequency(const IC::Interrupt_Id & i);
+
+private:
+    static DVFS_Timer * _timer;
+    static Governor _governor[CPUS];
+    static volatile unsigned int _cpu_temperature[CPUS];
+    static volatile Hertz _cpu_clock[CPUS];
+    static volatile Hertz _requested_clock[CPUS];
+    static volatile Hertz _effective_clock[CPUS];
+    static Hertz _decision[CPUS];
+    static Time_Stamp _last_sample[CPUS];
+    static Time_Stamp _last_idle[CPUS];
+    static Percent _cpu_load[CPUS];
+    static PMU::Count _last_instructions[CPUS];
+    static PMU::Count _last_cycles[CPUS];
+    static PMU::Count _last_llc_misses[CPUS];
+    static CPU::Reg64 _last_aperf[CPUS];
+    static CPU::Reg64 _last_mperf[CPUS];
+};
+
+__END_SYS
+
+#endif
@@ -74,6 +74,8 @@ public:
     void wait() { enter(); Component::wait(); leave(); }
     void signal() { enter(); Component::signal(); leave(); }
     void broadcast() { enter(); Component::broadcast(); leave(); }
+    static bool wait(volatile int * address, int value) { static_enter(); bool res = Component::wait(address, value); static_leave(); return res; }
+    static unsigned int wake(volatile int * address, unsigned int n) { static_enter(); unsigned int res = Component::wake(address, n); static_leave(); return res; }
 
     // Timing
     static void delay(const RTC::Microsecond & time) { static_enter(); Component::delay(time); static_leave(); }
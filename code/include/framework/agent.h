@@ -11,6 +11,7 @@
 #include <mutex.h>
 #include <semaphore.h>
 #include <condition.h>
+#include <futex.h>
 #include <clock.h>
 #include <alarm.h>
 #include <chronometer.h>
@@ -56,6 +57,7 @@ private:
     void handle_mutex();
     void handle_semaphore();
     void handle_condition();
+    void handle_futex();
     void handle_clock();
     void handle_alarm();
     void handle_chronometer();
@@ -292,6 +294,31 @@ void Agent::handle_condition()
 };
 
 
+void Agent::handle_futex()
+{
+    Result res = 0;
+
+    switch(method()) {
+    case FUTEX_WAIT: {
+        volatile int * address;
+        int value;
+        in(address, value);
+        res = Adapter<Futex>::wait(address, value);
+    } break;
+    case FUTEX_WAKE: {
+        volatile int * address;
+        unsigned int n;
+        in(address, n);
+        res = Adapter<Futex>::wake(address, n);
+    } break;
+    default:
+        res = UNDEFINED;
+    }
+
+    result(res);
+};
+
+
 void Agent::handle_clock()
 {
     result(UNDEFINED);
@@ -109,6 +109,9 @@ public:
     void signal() { _stub->signal(); }
     void broadcast() { _stub->broadcast(); }
 
+    static bool wait(volatile int * address, int value) { return _Stub::wait(address, value); }
+    static unsigned int wake(volatile int * address, unsigned int n = 1) { return _Stub::wake(address, n); }
+
     // Timing
     template<typename T>
     static void delay(T t) { _Stub::delay(t); }
@@ -36,12 +36,15 @@ __END_SYS
 #include <mutex.h>
 #include <semaphore.h>
 #include <condition.h>
+#include <futex.h>
 #include <communicator.h>
 
 #include "handle.h"
 
 #define BIND(X) typedef _SYS::IF<(_SYS::Traits<_SYS::X>::ASPECTS::Length || (_SYS::Traits<_SYS::Build>::MODE == _SYS::Traits<_SYS::Build>::KERNEL)), _SYS::Handle<_SYS::X>, _SYS::X>::Result X;
 #define EXPORT(X) typedef _SYS::X X;
+// User-mode tasks get synchronizers that only enter the kernel (through Futex) when a thread has to sleep or wake up another
+#define BIND_FUTEX(X) typedef _SYS::IF<(_SYS::Traits<_SYS::Build>::MODE == _SYS::Traits<_SYS::Build>::KERNEL), _SYS::Futex_##X<_SYS::Handle<_SYS::Futex>>, _SYS::IF<_SYS::Traits<_SYS::X>::ASPECTS::Length, _SYS::Handle<_SYS::X>, _SYS::X>::Result>::Result X;
 
 __BEGIN_API
 
@@ -63,9 +66,10 @@ BIND(Task);
 BIND(Address_Space);
 BIND(Segment);
 
-BIND(Mutex);
-BIND(Semaphore);
-BIND(Condition);
+BIND(Futex);
+BIND_FUTEX(Mutex);
+BIND_FUTEX(Semaphore);
+BIND_FUTEX(Condition);
 
 BIND(Clock);
 BIND(Chronometer);
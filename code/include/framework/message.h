@@ -72,6 +72,9 @@ public:
         SYNCHRONIZER_SIGNAL,
         SYNCHRONIZER_BROADCAST,
 
+        FUTEX_WAIT = COMPONENT,
+        FUTEX_WAKE,
+
         ALARM_DELAY = COMPONENT,
         ALARM_GET_PERIOD,
         ALARM_SET_PERIOD,
@@ -100,6 +100,9 @@ public:
     void signal() { invoke(SYNCHRONIZER_SIGNAL); }
     void broadcast() { invoke(SYNCHRONIZER_BROADCAST); }
 
+    static bool wait(volatile int * address, int value) { return static_invoke(FUTEX_WAIT, address, value); }
+    static unsigned int wake(volatile int * address, unsigned int n = 1) { return static_invoke(FUTEX_WAKE, address, n); }
+
     // Timing
     template<typename T>
     static void delay(T t) { static_invoke(ALARM_DELAY, t); }
@@ -0,0 +1,190 @@
+// EPOS Futex Component Declarations
+
+#ifndef __futex_h
+#define __futex_h
+
+#include <utility/hash.h>
+#include <cpu.h>
+#include <thread.h>
+#include <task.h>
+
+__BEGIN_SYS
+
+// Wait queues keyed by the address of an integer (a "fast user-space mutex" word). wait() puts the calling thread
+// to sleep only if the integer still holds the value it was given, and wake() wakes up threads waiting on it.
+// Both check and queue under the lock of the address' bucket in a hashed table, so a wake() that follows a change
+// to the integer can't get lost before a wait() that hasn't seen it yet. The address is keyed by its physical
+// address, so tasks sharing a segment can synchronize through it.
+class Futex
+{
+    friend class Thread;
+
+private:
+    static const bool smp = Traits<Thread>::smp;
+    static const unsigned int BUCKETS = 64;
+
+    typedef unsigned int Key;
+    typedef Thread::Queue Queue;
+
+    struct Waiter;
+    typedef Hash<Waiter, BUCKETS, Key> Table;
+    typedef Table::Element Element;
+
+    // Lives on the waiting thread's stack
+    struct Waiter
+    {
+        Waiter(const Key & k): link(this, k) {}
+
+        Queue queue;
+        Element link;
+    };
+
+public:
+    static bool wait(volatile int * address, int value);
+    static unsigned int wake(volatile int * address, unsigned int n = 1);
+
+private:
+    static void abandon(Thread * thread);
+
+    static Key key(volatile int * address) {
+        CPU::Log_Addr log = const_cast<int *>(address);
+        CPU::Phy_Addr phy = Traits<System>::multitask ? Task::self()->address_space()->physical(log) : CPU::Phy_Addr(log);
+        return static_cast<unsigned int>(phy) / sizeof(int);
+    }
+
+    static void lock(const Key & k) {
+        CPU::int_disable();
+        if(smp)
+            _locks[k % BUCKETS].acquire();
+    }
+
+    static void unlock(const Key & k) {
+        if(smp)
+            _locks[k % BUCKETS].release();
+        CPU::int_enable();
+    }
+
+private:
+    static Table _waiters;
+    static Simple_Spin _locks[BUCKETS];
+};
+
+
+// Synchronizers built on wait() and wake() of F (Futex itself or, for user-mode tasks, its Handle), which only
+// invoke them when a thread has to sleep or to wake up another one, so the uncontended cases never enter the kernel
+class Futex_Synchronizer
+{
+protected:
+    static int cas(volatile int & value, int compare, int replacement) { return CPU::cas(value, compare, replacement); }
+
+    static int exchange(volatile int & value, int replacement) {
+        int old;
+        do
+            old = value;
+        while(cas(value, old, replacement) != old);
+        return old;
+    }
+};
+
+template<typename F = Futex>
+class Futex_Mutex: private Futex_Synchronizer
+{
+private:
+    enum {
+        FREE,
+        LOCKED,
+        CONTENDED       // there might be threads waiting
+    };
+
+public:
+    Futex_Mutex(): _state(FREE) {}
+
+    void lock() {
+        int state = cas(_state, FREE, LOCKED);
+        if(state == FREE)
+            return;
+
+        if(state != CONTENDED)
+            state = exchange(_state, CONTENDED);
+        while(state != FREE) {
+            F::wait(&_state, CONTENDED);
+            state = exchange(_state, CONTENDED);
+        }
+    }
+
+    void unlock() {
+        if(CPU::fdec(_state) != LOCKED) {
+            _state = FREE;
+            F::wake(&_state);
+        }
+    }
+
+private:
+    volatile int _state;
+};
+
+template<typename F = Futex>
+class Futex_Semaphore: private Futex_Synchronizer
+{
+public:
+    Futex_Semaphore(int v = 1): _value(v), _waiters(0) {}
+
+    void p() {
+        for(;;) {
+            int value = _value;
+            if(value > 0) {
+                if(cas(_value, value, value - 1) == value)
+                    return;
+            } else {
+                CPU::finc(_waiters);
+                F::wait(&_value, value);
+                CPU::fdec(_waiters);
+            }
+        }
+    }
+
+    void v() {
+        CPU::finc(_value);
+        if(_waiters)
+            F::wake(&_value);
+    }
+
+private:
+    volatile int _value;
+    volatile int _waiters;
+};
+
+// Like Condition, signals reach only the threads already waiting
+template<typename F = Futex>
+class Futex_Condition: private Futex_Synchronizer
+{
+public:
+    Futex_Condition(): _sequence(0), _waiters(0) {}
+
+    void wait() {
+        int sequence = _sequence;
+        CPU::finc(_waiters);
+        F::wait(&_sequence, sequence);
+        CPU::fdec(_waiters);
+    }
+
+    void signal() {
+        CPU::finc(_sequence);
+        if(_waiters)
+            F::wake(&_sequence);
+    }
+
+    void broadcast() {
+        CPU::finc(_sequence);
+        if(_waiters)
+            F::wake(&_sequence, _waiters);
+    }
+
+private:
+    volatile int _sequence;
+    volatile int _waiters;
+};
+
+__END_SYS
+
+#endif
@@ -63,7 +63,7 @@ public:
     };
 
     // Interrupts
-    static const unsigned int INTS = 50;
+    static const unsigned int INTS = 51;
     enum {
         INT_FIRST_HARD  = HARD_INT,
         INT_TIMER       = HARD_INT + IRQ_TIMER,
@@ -71,6 +71,7 @@ public:
         INT_LAST_HARD   = HARD_INT + IRQ_LAST,
         INT_PERF_INIT   = HARD_INT + IRQ_PERF_INIT,
         INT_RESCHEDULER = SOFT_INT,
+        INT_FREQUENCY,
         INT_SYSCALL
     };
 
@@ -167,9 +168,10 @@ public:
         INT_TIMER       = i8259A::INT_TIMER,
         INT_KEYBOARD    = i8259A::INT_KEYBOARD,
         INT_RESCHEDULER = i8259A::INT_RESCHEDULER, // in multicores, reschedule goes via IPI, which must be acknowledged just like hardware
+        INT_FREQUENCY   = i8259A::INT_FREQUENCY,   // remote frequency changes also go via IPI (see DVFS::clock())
         INT_SYSCALL     = i8259A::INT_SYSCALL,
         INT_PERF_INIT   = i8259A::INT_PERF_INIT,
-        INT_LAST_HARD   = INT_RESCHEDULER
+        INT_LAST_HARD   = INT_FREQUENCY
     };
 
     // Default mapping addresses
@@ -492,6 +494,7 @@ public:
     using IC_Common::Interrupt_Id;
     using IC_Common::Interrupt_Handler;
     using Engine::INT_RESCHEDULER;
+    using Engine::INT_FREQUENCY;
     using Engine::INT_SYSCALL;
     using Engine::INT_TIMER;
     using Engine::INT_KEYBOARD;
@@ -539,19 +542,7 @@ public:
     using Engine::irq2int;
 
 private:
-    static void dispatch(unsigned int i) {
-        bool not_spurious = true;
-        if((i >= INT_FIRST_HARD) && (i <= INT_LAST_HARD))
-            not_spurious = eoi(i);
-        if(not_spurious) {
-            if((i != INT_TIMER) || Traits<IC>::hysterically_debugged)
-                db<IC>(TRC) << "IC::dispatch(i=" << i << ")" << endl;
-            _int_vector[i](i);
-        } else {
-            if(i != INT_LAST_HARD)
-                db<IC>(TRC) << "IC::spurious interrupt (" << i << ")" << endl;
-        }
-    }
+    static void dispatch(unsigned int i);
 
     // Logical handlers
     static void int_not(const Interrupt_Id & i);
@@ -73,6 +73,12 @@ template<> struct Traits<Timer>: public Traits<Machine_Common>
     // 10000 Hz. The choice must respect the scheduler time-slice, i. e.,
     // it must be higher than the scheduler invocation frequency.
     static const int FREQUENCY = 1000; // Hz
+
+    // Tickless idle: halted CPUs program the timer one-shot to their next event instead of ticking (multicore only)
+    static const bool tickless = true;
+
+    // High-resolution alarms: the local timer is split one-shot at Alarm(Nanosecond) deadlines (multicore only)
+    static const bool high_resolution = true;
 };
 
 template<> struct Traits<RTC>: public Traits<Machine_Common>
@@ -97,6 +97,9 @@ public:
         CPU::out8(cnt, count >> 8);
     }
 
+    // Counts left until the counter expires (counter 0 counts down twice per period in square wave mode)
+    static Count left(int channel) { return read(channel); }
+
     static Count read(int channel) {
         if(channel > 2)
             return 0;
@@ -231,6 +234,9 @@ public:
 
     static Count read(int channel) { return APIC::read_timer(); }
 
+    // Counts left until the next interrupt, in units of clock() (APIC::config_timer() prescales by 16)
+    static Count left(int channel) { return APIC::read_timer() * 16; }
+
     static void reset(int channel) { APIC::reset_timer(); }
 };
 
@@ -246,16 +252,23 @@ protected:
     typedef Engine::Count Count;
     typedef IC::Interrupt_Id Interrupt_Id;
 
-    static const unsigned int CHANNELS = 3;
+    static const unsigned int CHANNELS = 5;
     static const unsigned int FREQUENCY = Traits<Timer>::FREQUENCY;
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
 
 public:
     enum {
         SCHEDULER,
         ALARM,
-        USER
+        USER,
+        GOVERNOR,
+        PRECISE
     };
 
+    // One-shot mode is only available on the APIC timer
+    static const bool tickless = Traits<Timer>::tickless && Traits<System>::multicore;
+    static const bool high_resolution = Traits<Timer>::high_resolution && Traits<System>::multicore;
+
     using Timer_Common::Hertz;
     using Timer_Common::Tick;
     using Timer_Common::Microsecond;
@@ -301,10 +314,38 @@ public:
     static void enable() { IC::enable(IC::INT_TIMER); }
     static void disable() { IC::disable(IC::INT_TIMER); }
 
+    // Tickless idle
+    // Halts the CPU with the timer programmed one-shot to the earliest of the channels' next expiries and "alarm"
+    // (the ticks until the next request in this CPU's Alarm queue). When
+    // the CPU wakes up, the channels are caught up with the ticks it skipped, as measured by the TSC, and the
+    // timer ticks periodically again. CPU 0 keeps ticking, since its Alarm counts the system's time. Must be called
+    // with interrupts disabled.
+    static void halt(const Tick & alarm);
+
+    // Called at the entry of every interrupt but the timer's, which might dispatch a thread while the CPU is still
+    // halted in tickless mode, to resume the periodic tick first
+    static void awake() {
+        if(tickless && _horizon[Machine::cpu_id()])
+            resume(false);
+    }
+
+    // Makes "cpu" reconsider its next event if it is (about to be) halted in tickless mode (e.g. a new alarm)
+    static void wakeup(unsigned int cpu);
+
+    // High-resolution events
+    // Splits the current tick of this CPU with a one-shot that dispatches the PRECISE channel at "deadline" (a TSC
+    // time stamp) and then completes the tick. Deadlines beyond the next tick are ignored, so the PRECISE channel's
+    // owner must ask again at a later tick. Must be called with interrupts disabled.
+    static void precise(const TSC::Time_Stamp & deadline);
+
  private:
     static Hertz count2freq(const Count & c) { return c ? Engine::clock() / c : 0; }
     static Count freq2count(const Hertz & f) { return f ? Engine::clock() / f : 0; }
 
+    static bool handles_user(unsigned int cpu) { return !Traits<System>::multicore || (cpu == 0); }
+
+    static void resume(bool tick);
+
     static void int_handler(const Interrupt_Id & i);
 
     static void init();
@@ -317,6 +358,11 @@ protected:
     Handler _handler;
 
     static Timer * _channels[CHANNELS];
+    static volatile Tick _horizon[CPUS];                // ticks the CPU is halted for, 0 while ticking
+    static volatile TSC::Time_Stamp _halted[CPUS];
+    static volatile int _kicked[CPUS];                  // set by wakeup()
+    static volatile Count _split[CPUS];                 // engine counts left of the tick after a pending precise event
+    static volatile bool _oneshot[CPUS];                // the tick in progress was split by a precise event
 };
 
 
@@ -334,6 +380,20 @@ public:
     Alarm_Timer(const Handler & handler): Timer(ALARM, FREQUENCY, handler) {}
 };
 
+// Timer used by Alarm's high-resolution requests (fires between ticks, see Timer::precise())
+class Precise_Timer: public Timer
+{
+public:
+    Precise_Timer(const Handler & handler): Timer(PRECISE, FREQUENCY, handler) {}
+};
+
+// Timer used by DVFS (fires on every CPU, like Scheduler_Timer)
+class DVFS_Timer: public Timer
+{
+public:
+    DVFS_Timer(const Microsecond & period, const Handler & handler): Timer(GOVERNOR, 1000000 / period, handler) {}
+};
+
 // Timer available for users
 class User_Timer: public Timer
 {
@@ -8,8 +8,17 @@
 
 __BEGIN_SYS
 
+// Uncontended lock() and unlock() take a single CAS and no lock. A contended lock() spins while the owner is
+// running on another CPU and only then sleeps, in which case unlock() hands the mutex over to the thread it wakes up
 class Mutex: protected Synchronizer_Common
 {
+private:
+    enum {
+        FREE,
+        LOCKED,
+        CONTENDED       // there might be threads sleeping on the mutex
+    };
+
 public:
     Mutex();
     ~Mutex();
@@ -17,8 +26,75 @@ public:
     void lock();
     void unlock();
 
+private:
+    volatile int _state;
+    Thread * volatile _owner;
+};
+
+
+// Mutexes for real-time threads: they track their owners (and the owners the mutexes they hold), so the owner
+// inherits the priority of the most urgent thread waiting for it, and so on along nested waits. Priorities
+// change through Thread::inherit(), so threads stay in their queues of Scheduling_Multilist (on SMP, a
+// boosted owner on another CPU gets it rescheduled). The kernel path is always taken, for predictability,
+// and a single lock serializes all of them, so the propagation of priorities cannot deadlock.
+class Inheritance_Mutex: protected Synchronizer_Common
+{
+    friend class Thread;
+
+protected:
+    typedef Thread::Criterion Criterion;
+
+    enum { NONE = Criterion::IDLE }; // no ceiling
+
+public:
+    Inheritance_Mutex();
+    ~Inheritance_Mutex();
+
+    void lock();
+    void unlock();
+
+protected:
+    Inheritance_Mutex(int ceiling);
+
+private:
+    int level();
+    void acquire(Thread * owner);
+
+    static bool propagate(Thread * t, int inherited = NONE);
+
+    static void lock_chain() {
+        CPU::int_disable();
+        if(smp)
+            _chain.acquire();
+    }
+
+    static void unlock_chain() {
+        if(smp)
+            _chain.release();
+        CPU::int_enable();
+    }
+
 private:
     volatile bool _locked;
+    Thread * volatile _owner;
+    int _ceiling;
+    int _boost;     // what the ceiling was when the owner took the mutex
+    Simple_List<Inheritance_Mutex>::Element _link;
+
+    static Simple_Spin _chain;
+};
+
+
+// Immediate priority ceiling: the owner runs at the ceiling from lock() on, so no user of the mutex may
+// preempt it on its CPU, and inherits as above if a thread on another CPU has to wait. The ceiling is the
+// criterion of the most urgent user, e.g. Criterion(period) for RM. For dynamic criteria, it is built
+// from the shortest relative deadline among the users (e.g. Criterion(deadline) for EDF) and the owner
+// takes the deadline it yields at lock(), which realizes the Stack Resource Policy: only jobs released
+// afterwards with shorter relative deadlines than those of every user can preempt it.
+class Ceiling_Mutex: public Inheritance_Mutex
+{
+public:
+    Ceiling_Mutex(const Criterion & ceiling): Inheritance_Mutex(ceiling) {}
 };
 
 
@@ -26,8 +26,18 @@ protected:
     class Static_Handler: public Semaphore_Handler
     {
     public:
-        Static_Handler(Semaphore * s, Periodic_Thread * t): Semaphore_Handler(s) {}
+        Static_Handler(Semaphore * s, Periodic_Thread * t): Semaphore_Handler(s), _thread(t) {}
         ~Static_Handler() {}
+
+        void operator()() {
+            if(Criterion::partitioned)
+                _thread->repartition();
+
+            Semaphore_Handler::operator()();
+        }
+
+    private:
+        Periodic_Thread * _thread;
     };
 
     // Alarm Handler for periodic threads under dynamic scheduling policies
@@ -40,6 +50,9 @@ protected:
         void operator()() {
             _thread->criterion().update();
 
+            if(Criterion::partitioned)
+                _thread->repartition();
+
             Semaphore_Handler::operator()();
         }
 
@@ -49,6 +62,9 @@ protected:
 
     typedef IF<Criterion::dynamic, Dynamic_Handler, Static_Handler>::Result Handler;
 
+    static const bool high_resolution = Traits<Periodic_Thread>::high_resolution;
+    typedef IF<high_resolution, Alarm::Nanosecond, RTC::Microsecond>::Result Alarm_Time;
+
 public:
     typedef RTC::Microsecond Microsecond;
 
@@ -66,12 +82,12 @@ public:
     template<typename ... Tn>
     Periodic_Thread(const Microsecond & p, int (* entry)(Tn ...), Tn ... an)
     : Thread(Thread::Configuration(SUSPENDED, Criterion(p)), entry, an ...),
-      _semaphore(0), _handler(&_semaphore, this), _alarm(p, &_handler, INFINITE) { resume(); }
+      _semaphore(0), _handler(&_semaphore, this), _alarm(alarm_time(p), &_handler, INFINITE, alarm_cpu()) { resume(); }
 
     template<typename ... Tn>
     Periodic_Thread(const Configuration & conf, int (* entry)(Tn ...), Tn ... an)
     : Thread(Thread::Configuration(SUSPENDED, (conf.criterion != NORMAL) ? conf.criterion : Criterion(conf.period), conf.color, conf.task, conf.stack_size), entry, an ...),
-      _semaphore(0), _handler(&_semaphore, this), _alarm(conf.period, &_handler, conf.times) {
+      _semaphore(0), _handler(&_semaphore, this), _alarm(alarm_time(conf.period), &_handler, conf.times, alarm_cpu()) {
         if((conf.state == READY) || (conf.state == RUNNING)) {
             _state = SUSPENDED;
             resume();
@@ -91,6 +107,22 @@ public:
         return t->_alarm._times;
     }
 
+protected:
+    // Jobs are released with the thread out of the scheduler, so this is the moment to move it to
+    // another queue if DVFS slowed its CPU down below the needs of its task set (see Partitioner)
+    void repartition() {
+        lock_all();
+        if(_state == WAITING)
+            criterion().repartition();
+        unlock_all();
+    }
+
+    // With Traits<Periodic_Thread>::high_resolution, jobs are released at their exact period instead of at ticks
+    static Alarm_Time alarm_time(const Microsecond & p) { return Alarm_Time(high_resolution ? p * 1000ULL : p); }
+
+    // Partitioned criteria have jobs released by the timer of the thread's own CPU
+    int alarm_cpu() const { return (Criterion::QUEUES == Traits<Machine>::CPUS) ? static_cast<int>(_link.rank().queue()) : Alarm::ANY; }
+
 protected:
     Semaphore _semaphore;
     Handler _handler;
@@ -125,7 +157,7 @@ private:
 
             // Adjust alarm's period
             t->_alarm.~Alarm();
-            new (&t->_alarm) Alarm(t->criterion()._period, &t->_handler, times);
+            new (&t->_alarm) Alarm(alarm_time(t->criterion()._period), &t->_handler, times);
         }
 
         // Periodic execution loop
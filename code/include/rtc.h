@@ -30,6 +30,18 @@ public:
     // Infinite times (for alarms and periodic threads)
     enum { INFINITE = -1 };
 
+    // Times finer than a microsecond (for high-resolution alarms). It is a type of its own, so that
+    // Alarm(Nanosecond(t), ...) is a different request than Alarm(t, ...) and plain numbers keep meaning microseconds
+    class Nanosecond {
+    public:
+        explicit Nanosecond(unsigned long long ns = 0): _ns(ns) {}
+
+        operator unsigned long long() const { return _ns; }
+
+    private:
+        unsigned long long _ns;
+    };
+
     // Calendar date and time
     class Date {
     public:
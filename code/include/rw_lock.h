@@ -0,0 +1,41 @@
+// EPOS Reader-Writer Lock Component Declarations
+
+#ifndef __rw_lock_h
+#define __rw_lock_h
+
+#include <synchronizer.h>
+
+__BEGIN_SYS
+
+// Many readers or a single writer. A writer that has to wait keeps new readers out, so the readers inside drain
+// and writers take turns while any is waiting (readers may starve under a constant stream of writes, which read-
+// mostly data is not supposed to get). Like Mutex, uncontended operations take a single CAS and no lock;
+// otherwise, the lock is handed over to the threads woken up: the next writer, or else all waiting readers.
+class RW_Lock: protected Synchronizer_Common
+{
+private:
+    enum {
+        READERS = 0x0fffffff,   // number of readers inside
+        READING = 0x10000000,   // there might be readers sleeping on the lock
+        WRITING = 0x20000000,   // there might be writers sleeping on the lock
+        WRITER  = 0x40000000    // a writer is inside
+    };
+
+public:
+    RW_Lock();
+    ~RW_Lock();
+
+    void read_lock();
+    void read_unlock();
+
+    void write_lock();
+    void write_unlock();
+
+private:
+    volatile int _state;
+    Queue _readers; // writers sleep on Synchronizer_Common::_queue
+};
+
+__END_SYS
+
+#endif
@@ -4,6 +4,7 @@
 #define __scheduler_h
 
 #include <utility/list.h>
+#include <utility/spin.h>
 #include <cpu.h>
 #include <machine.h>
 
@@ -17,6 +18,7 @@ namespace Scheduling_Criteria
     // Priority (static and dynamic)
     class Priority
     {
+        friend class _SYS::Thread;
         friend class _SYS::RT_Thread;
 
     public:
@@ -32,6 +34,10 @@ namespace Scheduling_Criteria
         static const bool dynamic = false;
         static const bool preemptive = true;
         static const bool energy_aware = true;
+        static const bool partitioned = false;
+        static const bool migratable = false;
+
+        static const unsigned int QUEUES = 1;
 
     public:
         Priority(int p = NORMAL): _priority(p) {}
@@ -40,6 +46,11 @@ namespace Scheduling_Criteria
 
         void update() {}
         unsigned int queue() const { return 0; }
+        static unsigned int current_queue() { return 0; }
+
+        void repartition() {}
+        void unpartition() {}
+        bool migrate(unsigned int queue) { return false; }
 
     protected:
         volatile int _priority;
@@ -89,13 +100,15 @@ namespace Scheduling_Criteria
         enum {ANY = -1};
 
     protected:
-        Variable_Queue(unsigned int queue): _queue(queue) {};
+        Variable_Queue(unsigned int queue, bool pinned = false): _queue(queue), _pinned(pinned) {};
 
     public:
         const volatile unsigned int & queue() const volatile { return _queue; }
+        bool pinned() const { return _pinned; }
 
     protected:
         volatile unsigned int _queue;
+        bool _pinned; // hard affinity: explicitly assigned to a CPU, so never migrated nor stolen
         static volatile unsigned int _next_queue;
     };
 
@@ -112,21 +125,32 @@ namespace Scheduling_Criteria
     };
 
     // CPU Affinity
+    // Threads given a CPU are pinned to it (hard affinity), unless "hard" is false, in which case the CPU is
+    // just where they start (soft affinity), as for those placed round-robin, and idle CPUs may steal them
     class CPU_Affinity: public Priority, public Variable_Queue
     {
     public:
         static const bool timed = false;
         static const bool dynamic = false;
         static const bool preemptive = true;
+        static const bool migratable = true;
 
         static const unsigned int QUEUES = Traits<Machine>::CPUS;
 
     public:
-        CPU_Affinity(int p = NORMAL, int cpu = ANY)
-        : Priority(p), Variable_Queue(((_priority == IDLE) || (_priority == MAIN)) ? Machine::cpu_id() : (cpu != ANY) ? cpu : ++_next_queue %= Machine::n_cpus()) {}
+        CPU_Affinity(int p = NORMAL, int cpu = ANY, bool hard = true)
+        : Priority(p), Variable_Queue(((_priority == IDLE) || (_priority == MAIN)) ? Machine::cpu_id() : (cpu != ANY) ? cpu : ++_next_queue %= Machine::n_cpus(),
+                                      (_priority == IDLE) || (_priority == MAIN) || ((cpu != ANY) && hard)) {}
 
         using Variable_Queue::queue;
 
+        bool migrate(unsigned int queue) {
+            if(_pinned)
+                return false;
+            _queue = queue;
+            return true;
+        }
+
         static unsigned int current_queue() { return Machine::cpu_id(); }
     };
 
@@ -163,6 +187,63 @@ namespace Scheduling_Criteria
         Microsecond _capacity;
     };
 
+    // Utilization-based allocation of real-time tasks to the queues of partitioned criteria
+    // Utilizations are given in parts per FULL of a core running at its nominal clock. The share of a queue that
+    // can be allocated is its criterion's schedulability bound scaled by the current clock of its CPU (see DVFS),
+    // so a core slowed down by DVFS gets overloaded and its tasks are moved away at their next job release.
+    class Partitioner
+    {
+    private:
+        typedef RTC::Microsecond Microsecond;
+
+        static const unsigned int QUEUES = Traits<Machine>::CPUS;
+        static const unsigned int HEURISTIC = Traits<Scheduler<Thread> >::PARTITIONING;
+
+    public:
+        enum {
+            FIRST_FIT   = Traits<Scheduler<Thread> >::FIRST_FIT,
+            BEST_FIT    = Traits<Scheduler<Thread> >::BEST_FIT,
+            WORST_FIT   = Traits<Scheduler<Thread> >::WORST_FIT
+        };
+
+        static const unsigned int FULL = 1000000;
+
+    public:
+        static unsigned int utilization(const Microsecond & p, const Microsecond & c) {
+            return p ? static_cast<unsigned long long>(c) * FULL / p : 0;
+        }
+
+        static unsigned int load(unsigned int queue) { return _load[queue]; }
+        static unsigned int capacity(unsigned int queue, unsigned int bound);
+
+        static unsigned int allocate(unsigned int utilization, unsigned int bound);
+        static void reserve(unsigned int queue, unsigned int utilization);
+        static void release(unsigned int queue, unsigned int utilization);
+        static unsigned int migrate(unsigned int queue, unsigned int utilization, unsigned int bound);
+        static bool move(unsigned int from, unsigned int to, unsigned int utilization, unsigned int bound);
+
+    private:
+        static int fit(unsigned int utilization, unsigned int bound, int exclude = -1);
+
+        static bool lock() {
+            bool was_locked = CPU::int_disabled();
+            CPU::int_disable();
+            _lock.acquire();
+            return was_locked;
+        }
+
+        static void unlock(bool was_locked) {
+            _lock.release();
+            if(!was_locked)
+                CPU::int_enable();
+        }
+
+    private:
+        static volatile unsigned int _load[QUEUES];
+        static unsigned int _next_queue;
+        static Simple_Spin _lock;
+    };
+
     // Rate Monotonic
     class RM:public RT_Common
     {
@@ -183,18 +264,43 @@ namespace Scheduling_Criteria
         enum { ANY = Variable_Queue::ANY };
 
     public:
+        static const bool partitioned = true;
+        static const bool migratable = true;
+
         static const unsigned int QUEUES = Traits<Machine>::CPUS;
+        static const unsigned int BOUND = Partitioner::FULL / 1000 * 693; // Liu and Layland's bound for any number of tasks (ln 2)
 
     public:
         PRM(int p = APERIODIC)
-        : RM(p), Variable_Queue(((_priority == IDLE) || (_priority == MAIN)) ? Machine::cpu_id() : 0) {}
+        : RM(p), Variable_Queue(((_priority == IDLE) || (_priority == MAIN)) ? Machine::cpu_id() : 0, (_priority == IDLE) || (_priority == MAIN)) {}
 
         PRM(const Microsecond & d, const Microsecond & p = SAME, const Microsecond & c = UNKNOWN, int cpu = ANY)
-        : RM(d, p, c, cpu), Variable_Queue((cpu != ANY) ? cpu : ++_next_queue %= Machine::n_cpus()) {}
+        : RM(d, p ? p : d, c, cpu), Variable_Queue(partition(cpu), cpu != ANY) {}
 
         using Variable_Queue::queue;
 
+        unsigned int utilization() const { return Partitioner::utilization(_period, _capacity); }
+
+        void repartition() { _queue = Partitioner::migrate(_queue, utilization(), BOUND); }
+        void unpartition() { Partitioner::release(_queue, utilization()); }
+
+        bool migrate(unsigned int queue) {
+            if(_pinned || !Partitioner::move(_queue, queue, utilization(), BOUND))
+                return false;
+            _queue = queue;
+            return true;
+        }
+
         static unsigned int current_queue() { return Machine::cpu_id(); }
+
+    private:
+        unsigned int partition(int cpu) {
+            if(cpu == ANY)
+                return Partitioner::allocate(utilization(), BOUND);
+
+            Partitioner::reserve(cpu, utilization());
+            return cpu;
+        }
     };
 
 
@@ -248,18 +354,43 @@ namespace Scheduling_Criteria
           enum { ANY = Variable_Queue::ANY };
 
       public:
+          static const bool partitioned = true;
+          static const bool migratable = true;
+
           static const unsigned int QUEUES = Traits<Machine>::CPUS;
+          static const unsigned int BOUND = Partitioner::FULL;
 
       public:
           PEDF(int p = APERIODIC)
-          : EDF(p), Variable_Queue(((_priority == IDLE) || (_priority == MAIN)) ? Machine::cpu_id() : 0) {}
+          : EDF(p), Variable_Queue(((_priority == IDLE) || (_priority == MAIN)) ? Machine::cpu_id() : 0, (_priority == IDLE) || (_priority == MAIN)) {}
 
           PEDF(const Microsecond & d, const Microsecond & p = SAME, const Microsecond & c = UNKNOWN, int cpu = ANY)
-          : EDF(d, p, c, cpu), Variable_Queue((cpu != ANY) ? cpu : ++_next_queue %= Machine::n_cpus()) {}
+          : EDF(d, p ? p : d, c, cpu), Variable_Queue(partition(cpu), cpu != ANY) {}
 
           using Variable_Queue::queue;
 
+          unsigned int utilization() const { return Partitioner::utilization(_period, _capacity); }
+
+          void repartition() { _queue = Partitioner::migrate(_queue, utilization(), BOUND); }
+          void unpartition() { Partitioner::release(_queue, utilization()); }
+
+          bool migrate(unsigned int queue) {
+              if(_pinned || !Partitioner::move(_queue, queue, utilization(), BOUND))
+                  return false;
+              _queue = queue;
+              return true;
+          }
+
           static unsigned int current_queue() { return Machine::cpu_id(); }
+
+      private:
+          unsigned int partition(int cpu) {
+              if(cpu == ANY)
+                  return Partitioner::allocate(utilization(), BOUND);
+
+              Partitioner::reserve(cpu, utilization());
+              return cpu;
+          }
       };
 
       // Clustered Earliest Deadline First (multicore)
@@ -291,29 +422,63 @@ namespace Scheduling_Criteria
 template<typename T, typename R = typename T::Criterion>
 class Scheduling_Queue: public Scheduling_List<T> {};
 
+// Fixed-priority criteria can use the rank-indexed list, whose insertions don't walk the queue
+template<typename T, typename R = typename T::Criterion>
+class Fixed_Priority_Scheduling_List:
+public IF<Traits<Scheduler<T> >::indexed, Indexed_Scheduling_List<T, R>, Scheduling_List<T, R> >::Result {};
+
+template<typename T>
+class Scheduling_Queue<T, Scheduling_Criteria::Priority>:
+public Fixed_Priority_Scheduling_List<T> {};
+
+template<typename T>
+class Scheduling_Queue<T, Scheduling_Criteria::RR>:
+public Fixed_Priority_Scheduling_List<T> {};
+
+template<typename T>
+class Scheduling_Queue<T, Scheduling_Criteria::RM>:
+public Fixed_Priority_Scheduling_List<T> {};
+
+template<typename T>
+class Scheduling_Queue<T, Scheduling_Criteria::DM>:
+public Fixed_Priority_Scheduling_List<T> {};
+
 template<typename T>
 class Scheduling_Queue<T, Scheduling_Criteria::GRR>:
 public Multihead_Scheduling_List<T> {};
 
 template<typename T>
 class Scheduling_Queue<T, Scheduling_Criteria::CPU_Affinity>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, typename T::Criterion, typename Fixed_Priority_Scheduling_List<T>::Element, Fixed_Priority_Scheduling_List<T> > {};
 
 template<typename T>
 class Scheduling_Queue<T, Scheduling_Criteria::PRM>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, typename T::Criterion, typename Fixed_Priority_Scheduling_List<T>::Element, Fixed_Priority_Scheduling_List<T> > {};
+
+// EDF and its variants can keep their queues in heaps, since job releases reinsert threads with new deadlines
+template<typename T, typename R = typename T::Criterion>
+class Deadline_Scheduling_List:
+public IF<Traits<Scheduler<T> >::heap, Heap_Scheduling_List<T, R>, Scheduling_List<T, R> >::Result {};
+
+template<typename T, typename R = typename T::Criterion>
+class Multihead_Deadline_Scheduling_List:
+public IF<Traits<Scheduler<T> >::heap, Multihead_Heap_Scheduling_List<T, R>, Multihead_Scheduling_List<T, R> >::Result {};
+
+template<typename T>
+class Scheduling_Queue<T, Scheduling_Criteria::EDF>:
+public Deadline_Scheduling_List<T> {};
 
 template<typename T>
 class Scheduling_Queue<T, Scheduling_Criteria::GEDF>:
-public Multihead_Scheduling_List<T> {};
+public Multihead_Deadline_Scheduling_List<T> {};
 
 template<typename T>
 class Scheduling_Queue<T, Scheduling_Criteria::PEDF>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, typename T::Criterion, typename Deadline_Scheduling_List<T>::Element, Deadline_Scheduling_List<T> > {};
 
 template<typename T>
 class Scheduling_Queue<T, Scheduling_Criteria::CEDF>:
-public Multihead_Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, typename T::Criterion, typename Multihead_Deadline_Scheduling_List<T>::Element, Multihead_Deadline_Scheduling_List<T> > {};
 
 
 // Scheduler
@@ -329,8 +494,8 @@ private:
 
 public:
     typedef typename T::Criterion Criterion;
-    typedef Scheduling_List<T, Criterion> Queue;
-    typedef typename Queue::Element Element;
+    typedef typename Base::Element Element;
+    typedef typename Base::Iterator Iterator;
 
 public:
     Scheduler() {}
@@ -358,6 +523,13 @@ public:
         return Base::remove(obj->link()) ? obj : 0;
     }
 
+    // Removes "obj" from "queue", in which it is while its criterion already names another (e.g. after migrate())
+    T * remove(T * obj, unsigned int queue) {
+        db<Scheduler>(TRC) << "Scheduler[chosen=" << chosen() << "]::remove(" << obj << ",q=" << queue << ")" << endl;
+
+        return Base::remove(obj->link(), queue) ? obj : 0;
+    }
+
     void suspend(T * obj) {
         db<Scheduler>(TRC) << "Scheduler[chosen=" << chosen() << "]::suspend(" << obj << ")" << endl;
 
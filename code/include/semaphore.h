@@ -8,6 +8,8 @@
 
 __BEGIN_SYS
 
+// Like Mutex, p() and v() take a single CAS and no lock while no thread has to sleep, and a p() that would
+// sleep first spins for a while on SMP
 class Semaphore: protected Synchronizer_Common
 {
 public:
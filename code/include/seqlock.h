@@ -0,0 +1,72 @@
+// EPOS Sequence Lock Component Declarations
+
+#ifndef __seqlock_h
+#define __seqlock_h
+
+#include <cpu.h>
+
+__BEGIN_SYS
+
+// A record read much more often than written (e.g. a per-CPU frequency or temperature snapshot). Readers never
+// write to shared memory nor block: they copy the record and try again if a writer was at it meanwhile, which
+// the sequence number tells (it is odd while a write is in progress). Writers serialize on the sequence number
+// with interrupts disabled, so a reader that preempted a writer on its CPU doesn't spin forever. T is copied
+// while it may be written, so it must be plain data small enough for retries to be rare.
+template<typename T>
+class Seqlock
+{
+public:
+    Seqlock(): _sequence(0) {}
+    Seqlock(const T & t): _sequence(0), _data(t) {}
+
+    T read() const {
+        for(;;) {
+            unsigned int sequence = begin();
+            T t = _data;
+            if(!retry(sequence))
+                return t;
+        }
+    }
+
+    void write(const T & t) {
+        bool enabled = CPU::int_enabled();
+        CPU::int_disable();
+
+        unsigned int sequence;
+        do
+            sequence = _sequence;
+        while((sequence & 1) || (CPU::cas(_sequence, sequence, sequence + 1) != sequence));
+        CPU::barrier();
+
+        _data = t;
+
+        CPU::barrier();
+        _sequence = sequence + 2;
+
+        if(enabled)
+            CPU::int_enable();
+    }
+
+    // For readers that only need some fields of large records: begin(), read them, and start over if retry()
+    unsigned int begin() const {
+        unsigned int sequence;
+        while((sequence = _sequence) & 1);
+        CPU::barrier();
+        return sequence;
+    }
+
+    bool retry(unsigned int sequence) const {
+        CPU::barrier();
+        return _sequence != sequence;
+    }
+
+    const T & data() const { return _data; }
+
+private:
+    volatile unsigned int _sequence;
+    T _data;
+};
+
+__END_SYS
+
+#endif
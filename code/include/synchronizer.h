@@ -8,30 +8,58 @@
 
 __BEGIN_SYS
 
+// Each synchronizer has its own lock, taken before any of Thread's scheduler locks,
+// so operations on different synchronizers don't serialize (see Thread::lock())
 class Synchronizer_Common
 {
 protected:
     typedef Thread::Queue Queue;
 
+    static const bool smp = Traits<Thread>::smp;
+    static const int SPIN = Traits<Synchronizer>::SPIN;
+
 protected:
-    Synchronizer_Common() {}
+    Synchronizer_Common(): _spins(0) {}
     ~Synchronizer_Common() { begin_atomic(); wakeup_all(); }
 
     // Atomic operations
     bool tsl(volatile bool & lock) { return CPU::tsl(lock); }
     int finc(volatile int & number) { return CPU::finc(number); }
     int fdec(volatile int & number) { return CPU::fdec(number); }
+    int cas(volatile int & value, int compare, int replacement) { return CPU::cas(value, compare, replacement); }
+
+    // Adaptive spinning (SMP only)
+    // Contended operations spin before sleeping for up to twice the average number of iterations that
+    // spinning took on this synchronizer (bounded by Traits<Synchronizer>::SPIN), so synchronizers whose
+    // critical sections are long soon stop wasting CPU time on it
+    int spin_limit() const { return !smp ? 0 : (_spins * 2 + 10 < SPIN) ? _spins * 2 + 10 : SPIN; }
+    void spun(int n) { _spins += (n - _spins) / 8; }
 
     // Thread operations
-    void begin_atomic() { Thread::lock(); }
-    void end_atomic() { Thread::unlock(); }
+    void begin_atomic() {
+        CPU::int_disable();
+        if(smp)
+            _lock.acquire();
+    }
+
+    void end_atomic() {
+        if(smp)
+            _lock.release();
+        CPU::int_enable();
+    }
+
+    void sleep(Queue * q) { Thread::sleep(q, &_lock); }
+    void wakeup(Queue * q) { Thread::wakeup(q, &_lock); }
+    void wakeup_all(Queue * q) { Thread::wakeup_all(q, &_lock); }
 
-    void sleep() { Thread::sleep(&_queue); }
-    void wakeup() { Thread::wakeup(&_queue); }
-    void wakeup_all() { Thread::wakeup_all(&_queue); }
+    void sleep() { sleep(&_queue); }
+    void wakeup() { wakeup(&_queue); }
+    void wakeup_all() { wakeup_all(&_queue); }
 
 protected:
     Queue _queue;
+    Simple_Spin _lock;
+    volatile int _spins;
 };
 
 __END_SYS
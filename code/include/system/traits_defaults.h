@@ -0,0 +1,100 @@
+// EPOS Configuration Defaults
+
+// Default values for the configuration knobs of the components below. Each traits file includes this header right
+// after its primary Traits template and derives Traits<X> from Default_Traits<X>, so it only states what it changes.
+
+#ifndef __traits_defaults_h
+#define __traits_defaults_h
+
+__BEGIN_SYS
+
+template<typename T> struct Default_Traits;
+
+template<> struct Default_Traits<Spin>: public Traits<void>
+{
+    // Lock algorithms (see utility/spin.h)
+    enum {TAS, TICKET, MCS};
+    static const unsigned int RECURSIVE = TAS;   // Spin (e.g. Thread's scheduler locks)
+    static const unsigned int SIMPLE = TAS;      // Simple_Spin (e.g. synchronizers and Alarm)
+    static const unsigned int HEAP = TAS;        // the system heap lock
+};
+
+template<> struct Default_Traits<Thread>: public Traits<void>
+{
+    static const unsigned int DVFS_PERIOD = 50000; // us
+
+    static const bool monitored = false; // per-thread PMU counts (see Thread::counters())
+    static const bool stealing = true; // idle CPUs steal READY threads from other CPUs' queues (see Work_Stealer)
+};
+
+template<> struct Default_Traits<DVFS>: public Traits<void>
+{
+    typedef DVFS_Governors::Hysteresis Governor;
+
+    // Hysteresis: throttle at MAX_TEMPERATURE and restore the nominal clock at MIN_TEMPERATURE (Celsius)
+    static const unsigned int MAX_TEMPERATURE = 45;
+    static const unsigned int MIN_TEMPERATURE = 40;
+    static const unsigned long THROTTLED_CLOCK = 896146304; // Hz
+
+    // PID: track TARGET_TEMPERATURE (Celsius); gains in per-mille of the nominal clock per Celsius
+    static const unsigned int TARGET_TEMPERATURE = 42;
+    static const int KP = 100;
+    static const int KI = 10;
+    static const int KD = 50;
+
+    // Ondemand: nominal clock above UP_THRESHOLD, scale down below DOWN_THRESHOLD (busy percentage)
+    static const unsigned int UP_THRESHOLD = 80;
+    static const unsigned int DOWN_THRESHOLD = 30;
+
+    // Memory_Aware: threads above MPKI_THRESHOLD LLC misses per kilo-instruction and below IPC_THRESHOLD (per-mille)
+    // instructions per cycle are memory bound and run at MEMORY_BOUND_CLOCK (percentage of the nominal clock)
+    static const unsigned int MPKI_THRESHOLD = 10;
+    static const unsigned int IPC_THRESHOLD = 500;
+    static const unsigned int MEMORY_BOUND_CLOCK = 60;
+
+    // Thermal migration of READY threads from the hottest to the coolest core (for CPU_Affinity, PRM and PEDF)
+    static const bool migration = true;
+    static const unsigned int MIGRATION_TEMPERATURE = 43;       // the hottest core must be at least this hot
+    static const unsigned int MIGRATION_DELTA = 3;              // and this much hotter than the coolest one
+    static const unsigned int MIGRATION_INTERVAL = 200000;      // us between migrations
+};
+
+template<> struct Default_Traits<Trace>: public Traits<void>
+{
+    static const bool enabled = false;
+
+    // Per-CPU ring size in records of 32 bytes (a power of 2 keeps indexing cheap)
+    static const unsigned int RECORDS = 1024;
+
+    // OVERWRITE keeps the most recent records; STOP keeps the oldest ones and drops the rest until drained
+    enum {OVERWRITE, STOP};
+    static const unsigned int MODE = OVERWRITE;
+};
+
+template<> struct Default_Traits<Scheduler<Thread> >: public Traits<void>
+{
+    // Task-to-queue allocation heuristic of partitioned real-time criteria (see Scheduling_Criteria::Partitioner)
+    enum {FIRST_FIT, BEST_FIT, WORST_FIT};
+    static const unsigned int PARTITIONING = WORST_FIT;
+
+    // Rank-indexed run queues for fixed-priority criteria (see Indexed_Scheduling_List)
+    static const bool indexed = true;
+
+    // Heap-ordered run queues for EDF and its variants (see Heap_Scheduling_List)
+    static const bool heap = true;
+};
+
+template<> struct Default_Traits<Periodic_Thread>: public Traits<void>
+{
+    static const bool high_resolution = false; // jobs released by Alarm(Nanosecond), see Timer::precise()
+};
+
+template<> struct Default_Traits<Synchronizer>: public Traits<void>
+{
+    // Iterations a contended Mutex::lock() or Semaphore::p() may spin before sleeping (SMP only)
+    static const int SPIN = 1000;
+};
+
+__END_SYS
+
+#endif
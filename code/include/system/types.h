@@ -122,6 +122,8 @@ class Active;
 class Periodic_Thread;
 class RT_Thread;
 class Task;
+class DVFS;
+class Trace;
 
 template<typename> class Scheduler;
 namespace Scheduling_Criteria
@@ -139,6 +141,13 @@ namespace Scheduling_Criteria
     class CEDF;
     class PRM;
 };
+namespace DVFS_Governors
+{
+    class Hysteresis;
+    class PID;
+    class Ondemand;
+    class Memory_Aware;
+};
 
 class Address_Space;
 class Segment;
@@ -147,6 +156,7 @@ class Synchronizer;
 class Mutex;
 class Semaphore;
 class Condition;
+class Futex;
 
 class Clock;
 class Chronometer;
@@ -226,6 +236,7 @@ enum
     MUTEX_ID,
     SEMAPHORE_ID,
     CONDITION_ID,
+    FUTEX_ID,
 
     CLOCK_ID,
     ALARM_ID,
@@ -273,6 +284,7 @@ template<> struct Type<Segment> { static const Type_Id ID = SEGMENT_ID; };
 template<> struct Type<Mutex> { static const Type_Id ID = MUTEX_ID; };
 template<> struct Type<Semaphore> { static const Type_Id ID = SEMAPHORE_ID; };
 template<> struct Type<Condition> { static const Type_Id ID = CONDITION_ID; };
+template<> struct Type<Futex> { static const Type_Id ID = FUTEX_ID; };
 
 template<> struct Type<Clock> { static const Type_Id ID = CLOCK_ID; };
 template<> struct Type<Chronometer> { static const Type_Id ID = CHRONOMETER_ID; };
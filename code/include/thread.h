@@ -6,41 +6,56 @@
 #include <utility/queue.h>
 #include <utility/handler.h>
 #include <cpu.h>
+#include <tsc.h>
 #include <machine.h>
 #include <system.h>
 #include <scheduler.h>
 #include <segment.h>
-#include <pmu.h>
-#include <architecture/ia32/thermal.h>
 
 
 extern "C" { void __exit(); }
 
 __BEGIN_SYS
 
+template<typename> class Queue_Migrator;
+template<typename> class Work_Stealer;
+class No_Work_Stealer;
+class Inheritance_Mutex;
+
 class Thread
 {
     friend class Init_First;
     friend class System;
     friend class Scheduler<Thread>;
     friend class Synchronizer_Common;
+    friend class Inheritance_Mutex;
+    friend class Futex;
     friend class Alarm;
     friend class Task;
     friend class Agent;
+    friend class DVFS;
+    friend class Trace;
+    template<typename> friend class Thermal_Balancer;
+    template<typename> friend class Work_Stealer;
+    template<typename> friend class Queue_Migrator;
 
 protected:
     static const bool smp = Traits<Thread>::smp;
     static const bool preemptive = Traits<Thread>::Criterion::preemptive;
     static const bool multitask = Traits<System>::multitask;
     static const bool reboot = Traits<System>::reboot;
+    static const bool monitored = Traits<Thread>::monitored;
 
     static const unsigned int QUANTUM = Traits<Thread>::QUANTUM;
+    static const unsigned int LOCKS = Traits<Thread>::Criterion::QUEUES;
     static const unsigned int STACK_SIZE = multitask ? Traits<System>::STACK_SIZE : Traits<Application>::STACK_SIZE;
     static const unsigned int USER_STACK_SIZE = Traits<Application>::STACK_SIZE;
 
     typedef CPU::Log_Addr Log_Addr;
     typedef CPU::Context Context;
 
+    typedef IF<Traits<Thread>::stealing && Traits<Thread>::Criterion::migratable && (Traits<Machine>::CPUS > 1), Work_Stealer<Thread>, No_Work_Stealer>::Result Stealer;
+
 public:
     // Thread State
     enum State {
@@ -50,12 +65,6 @@ public:
         WAITING,
         FINISHING
     };
-	/* area de testes para plotagem */
-	static int _tempPos[Traits<Build>::CPUS];
-	static int _graficoTemp[Traits<Build>::CPUS][2000];
-	static int _graficoInst[Traits<Build>::CPUS][2000];
-	static int _graficoMiss[Traits<Build>::CPUS][2000];
-    static bool _fim;
 
     // Thread Priority
     typedef Scheduling_Criteria::Priority Priority;
@@ -87,6 +96,16 @@ public:
     // Thread Queue
     typedef Ordered_Queue<Thread, Criterion, Scheduler<Thread>::Element> Queue;
 
+    // Thread Performance Counters
+    // Events counted by the PMU while the thread was running, accumulated at each context switch
+    struct Counters {
+        Counters(): instructions(0), cycles(0), llc_misses(0) {}
+
+        unsigned long long instructions;
+        unsigned long long cycles;      // core cycles, at the core's current clock (see DVFS::CYCLES)
+        unsigned long long llc_misses;
+    };
+
 public:
     template<typename ... Tn>
     Thread(int (* entry)(Tn ...), Tn ... an);
@@ -101,6 +120,14 @@ public:
 
     Task * task() const { return _task; }
 
+    // Include the ongoing quantum only if called by the thread itself (or for a thread running on the caller's CPU)
+    Counters counters() const;
+
+    // Execution time normalized to the nominal clock, and thus comparable to capacities regardless of DVFS
+    // Core cycles only advance at the clock the core actually runs (as IA32_APERF), so the same work takes the same
+    // cycles whatever the P-state, turbo or throttling
+    RTC::Microsecond consumed() const { return counters().cycles * 1000000 / CPU::clock(); }
+
     int join();
     void pass();
     void suspend() { suspend(false); }
@@ -120,25 +147,90 @@ protected:
 
     Criterion & criterion() { return const_cast<Criterion &>(_link.rank()); }
 
-    static void lock() {
+    // Scheduler locks
+    // Criteria with several scheduling queues (e.g. CPU_Affinity, PEDF) have one lock per queue, so CPUs only
+    // contend when they touch each other's queues; the others have a single lock. Locks are taken with
+    // interrupts disabled and always in increasing queue order: lock(q1, q2) for operations spanning two
+    // queues (e.g. migration) and lock_all() for rare ones that may touch any (e.g. creation, join, exit).
+    // A synchronizer's own lock, if any, is taken before them (see Synchronizer_Common). Threads change
+    // queues only while holding the locks of both, so lock_queue(t) rechecks the queue once it holds it.
+    // dispatch() releases the lock of the current CPU's queue, which must then be the only one held. With migratable
+    // criteria, prev's context is cleared before that and only restored when switch_context() saves it, so threads
+    // are only moved to another queue once it holds a valid context (see Queue_Migrator). Other criteria don't clear
+    // it, since any CPU sharing the queue might legitimately choose prev as soon as the lock is released.
+    static void lock() { lock(current_queue()); }
+
+    static void lock(unsigned int queue) {
+        CPU::int_disable();
+        if(smp)
+            _lock[index(queue)].acquire();
+    }
+
+    static void lock(unsigned int q1, unsigned int q2) {
+        CPU::int_disable();
+        if(smp) {
+            unsigned int i1 = index(q1);
+            unsigned int i2 = index(q2);
+            _lock[(i1 < i2) ? i1 : i2].acquire();
+            if(i1 != i2)
+                _lock[(i1 < i2) ? i2 : i1].acquire();
+        }
+    }
+
+    static void lock_all() {
         CPU::int_disable();
         if(smp)
-            _lock.acquire();
+            for(unsigned int i = 0; i < LOCKS; i++)
+                _lock[i].acquire();
+    }
+
+    static unsigned int lock_queue(Thread * t);
+
+    static void release(unsigned int queue) {
+        if(smp)
+            _lock[index(queue)].release();
+    }
+
+    static void release_all_but(unsigned int queue) {
+        if(smp)
+            for(unsigned int i = 0; i < LOCKS; i++)
+                if(i != index(queue))
+                    _lock[i].release();
+    }
+
+    static void unlock() { unlock(current_queue()); }
+
+    static void unlock(unsigned int queue) {
+        release(queue);
+        CPU::int_enable();
+    }
+
+    static void unlock(unsigned int q1, unsigned int q2) {
+        release(q1);
+        if(index(q1) != index(q2))
+            release(q2);
+        CPU::int_enable();
     }
 
-    static void unlock() {
+    static void unlock_all() {
         if(smp)
-            _lock.release();
+            for(unsigned int i = 0; i < LOCKS; i++)
+                _lock[i].release();
         CPU::int_enable();
     }
 
     static bool locked() { return CPU::int_disabled(); }
 
+    static unsigned int current_queue() { return (LOCKS > 1) ? Criterion::current_queue() : 0; }
+    static unsigned int index(unsigned int queue) { return (LOCKS > 1) ? queue : 0; }
+
     void suspend(bool locked);
 
-    static void sleep(Queue * q);
-    static void wakeup(Queue * q);
-    static void wakeup_all(Queue * q);
+    static void sleep(Queue * q, Simple_Spin * lock);
+    static void wakeup(Queue * q, Simple_Spin * lock);
+    static void wakeup_all(Queue * q, Simple_Spin * lock);
+
+    void inherit(int priority);
 
     static void reschedule();
     static void reschedule(unsigned int cpu);
@@ -146,8 +238,10 @@ protected:
     static void time_slicer(const IC::Interrupt_Id & interrupt);
 
     static void dispatch(Thread * prev, Thread * next, bool charge = true);
+    static void account(Thread * prev);
 
     static int idle();
+    static void wake_from_idle(unsigned int cpu);
 
 private:
     static void init();
@@ -162,12 +256,20 @@ protected:
     Queue * _waiting;
     Thread * volatile _joining;
     Queue::Element _link;
+    volatile unsigned int _phase; // as classified by per-thread DVFS governors (see DVFS_Governors::Memory_Aware)
+    Counters _counters;
+    Inheritance_Mutex * volatile _blocker;  // the Inheritance_Mutex the thread waits for, if any
+    Simple_List<Inheritance_Mutex> _held;   // the Inheritance_Mutexes it owns
+    int _natural;                           // its priority without inheritance, while it owns any
+    volatile unsigned int _futex;           // the key of the Futex it waits on, if any (see Futex::abandon())
 
     static volatile unsigned int _thread_count;
     static Scheduler_Timer * _timer;
     static Scheduler<Thread> _scheduler;
-    static Spin _lock;
-    static int _cpu_temperature[Traits<Build>::CPUS];
+    static Spin _lock[LOCKS];
+    static volatile TSC::Time_Stamp _idle_time[Traits<Build>::CPUS];
+    static volatile TSC::Time_Stamp _halted[Traits<Build>::CPUS]; // when idle() halted each CPU (0 if it is not halted)
+    static Counters _checkpoint[Traits<Build>::CPUS]; // PMU readings at the last context switch of each CPU
     static Spin _print_lock;
 };
 
@@ -179,7 +281,7 @@ __BEGIN_SYS
 
 template<typename ... Tn>
 inline Thread::Thread(int (* entry)(Tn ...), Tn ... an)
-: _task(Task::self()), _user_stack(0), _state(READY), _waiting(0), _joining(0), _link(this, NORMAL)
+: _task(Task::self()), _user_stack(0), _state(READY), _waiting(0), _joining(0), _link(this, NORMAL), _phase(0), _blocker(0), _natural(0), _futex(0)
 {
     constructor_prologue(WHITE, STACK_SIZE);
     _context = CPU::init_stack(0, _stack + STACK_SIZE, &__exit, entry, an ...);
@@ -188,7 +290,7 @@ inline Thread::Thread(int (* entry)(Tn ...), Tn ... an)
 
 template<typename ... Tn>
 inline Thread::Thread(const Configuration & conf, int (* entry)(Tn ...), Tn ... an)
-: _task(conf.task ? conf.task : Task::self()), _state(conf.state), _waiting(0), _joining(0), _link(this, conf.criterion)
+: _task(conf.task ? conf.task : Task::self()), _state(conf.state), _waiting(0), _joining(0), _link(this, conf.criterion), _phase(0), _blocker(0), _natural(0), _futex(0)
 {
     if(multitask && !conf.stack_size) { // Auto-expand, user-level stack
         constructor_prologue(conf.color, STACK_SIZE);
@@ -238,6 +340,81 @@ private:
     Thread * _handler;
 };
 
+
+// Migration of READY threads between the per-CPU queues of migratable criteria (see Work_Stealer and Thermal_Balancer)
+template<typename T>
+class Queue_Migrator
+{
+private:
+    typedef typename Scheduler<T>::Iterator Iterator;
+
+public:
+    // Moves the first thread of queue "from" that may run elsewhere to queue "to", returning it, if any
+    // Threads with hard affinity (see Variable_Queue) never move, nor do those whose CPU is still saving their
+    // context (see Thread::dispatch()). The locks of both queues must be held (see Thread::lock(q1, q2)).
+    static T * move(unsigned int from, unsigned int to) {
+        T * t = 0;
+        for(Iterator i = T::_scheduler.begin(from); i != T::_scheduler.end(); i++)
+            if(!i->object()->criterion().pinned() && i->object()->_context) {
+                t = i->object();
+                break;
+            }
+
+        // Threads in the scheduling list of another CPU are READY (the running one is the list's chosen)
+        // The criterion is migrated first, so a thread that can't move keeps its place ahead of its peers
+        if(!t || !t->criterion().migrate(to))
+            return 0;
+
+        T::_scheduler.remove(t, from);
+        T::_scheduler.insert(t);
+
+        return t;
+    }
+};
+
+
+// Work stealing
+// Invoked by idle threads, it moves the first movable READY thread of the most loaded CPU's queue to the
+// idle CPU's one (see Queue_Migrator). Queue sizes are read without locks, just to choose the victim.
+template<typename T>
+class Work_Stealer
+{
+public:
+    // Returns the stolen thread, if any, already in the caller's queue
+    static T * steal() {
+        unsigned int thief = T::current_queue();
+
+        // Besides the threads waiting to run, the queue of a busy CPU holds its idle thread
+        unsigned int victim = thief;
+        unsigned int waiting = 1;
+        for(unsigned int i = 0; i < Machine::n_cpus(); i++)
+            if((i != thief) && (T::_scheduler.size(i) > waiting)) {
+                victim = i;
+                waiting = T::_scheduler.size(i);
+            }
+
+        if(victim == thief)
+            return 0;
+
+        T::lock(victim, thief);
+        T * t = Queue_Migrator<T>::move(victim, thief);
+        T::unlock(victim, thief);
+
+        if(!t)
+            return 0;
+
+        db<Thread>(INF) << "Work_Stealer::steal(): " << t << " moved from CPU " << victim << " to CPU " << thief << endl;
+
+        return t;
+    }
+};
+
+class No_Work_Stealer
+{
+public:
+    static Thread * steal() { return 0; }
+};
+
 __END_SYS
 
 #endif
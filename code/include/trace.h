@@ -0,0 +1,110 @@
+// EPOS Trace Component Declarations
+
+// Per-CPU binary trace of scheduling and DVFS events (see DVFS and Thread::dispatch()).
+// Each CPU only writes to its own ring and does it with interrupts disabled, so
+// recording takes neither locks nor atomic instructions. Records can be drained
+// from any CPU concurrently with recording. In OVERWRITE mode, the writer never
+// waits for the reader and drain() discards records that were overwritten while
+// being copied; in STOP mode, records are dropped while the ring is full.
+// dump() drains all rings to an OStream as text lines that survive serial
+// consoles and can be mixed with other output (see tools/epostrace):
+//   "#H <version> <TSC frequency> <CPUs> <record size>"    header
+//   "#T <base64 record>"                                    one per record
+//   "#L <cpu> <lost records>"                               one per CPU
+
+#ifndef __trace_h
+#define __trace_h
+
+#include <utility/ostream.h>
+#include <cpu.h>
+#include <tsc.h>
+#include <machine.h>
+
+__BEGIN_SYS
+
+class Trace
+{
+    friend class System;
+
+private:
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
+    static const unsigned int RECORDS = Traits<Trace>::RECORDS;
+    static const unsigned int MODE = Traits<Trace>::MODE;
+    static const unsigned int VERSION = 1;
+
+public:
+    static const bool enabled = Traits<Trace>::enabled;
+
+    enum {
+        OVERWRITE   = Traits<Trace>::OVERWRITE,
+        STOP        = Traits<Trace>::STOP
+    };
+
+    enum Event {
+        SAMPLE = 1,     // periodic DVFS sample
+        DISPATCH,       // context switch (thread is the one dispatched)
+        CLOCK,          // clock change (clock is the new one)
+        MIGRATION,      // thread moved by thermal migration (recorded by CPU 0) or stolen by an idle CPU (recorded by it)
+        USER            // recorded by the application
+    };
+
+    // Records are 32 bytes long
+    struct Record
+    {
+        TSC::Time_Stamp time_stamp;
+        unsigned int instructions;      // PMU counters (low 32 bits, wrap around)
+        unsigned int cycles;
+        unsigned int llc_misses;
+        unsigned int clock;             // Hz
+        unsigned int thread;
+        unsigned char ready;            // threads in the CPU's scheduling queue (saturated at 255)
+        unsigned char temperature;      // Celsius
+        unsigned char event;
+        unsigned char cpu;
+    } __attribute__((packed));
+
+public:
+    Trace() {}
+
+    static void record(const Event & event, const void * thread = 0) {
+        if(!enabled)
+            return;
+
+        bool was_locked = CPU::int_disabled();
+        CPU::int_disable();
+        write(event, thread);
+        if(!was_locked)
+            CPU::int_enable();
+    }
+
+    // Copies up to "n" of the oldest records of "cpu" into "buffer" and removes them from the ring
+    static unsigned int drain(unsigned int cpu, Record * buffer, unsigned int n);
+
+    // Drains all CPUs' rings to "out"
+    static void dump(OStream & out);
+
+    static unsigned int size(unsigned int cpu) { return _ring[cpu].head - _ring[cpu].tail; }
+    static unsigned int lost(unsigned int cpu) { return _ring[cpu].lost; }
+
+private:
+    static void init();
+
+    static void write(const Event & event, const void * thread);
+    static void encode(const Record & record, char * line);
+
+private:
+    // head and tail are free-running counters, the slot being "counter % RECORDS"
+    struct Ring
+    {
+        Record * records;
+        volatile unsigned int head;
+        volatile unsigned int tail;
+        volatile unsigned int lost;
+    };
+
+    static Ring _ring[CPUS];
+};
+
+__END_SYS
+
+#endif
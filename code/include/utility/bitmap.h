@@ -54,6 +54,20 @@ public:
         return true;
     }
 
+    // Lowest set index from "index" on or -1 if there is none (bsf on IA-32)
+    int next(unsigned int index) const {
+        if(index >= BITS)
+            return -1;
+        unsigned int i = index / BPI;
+        unsigned int word = _map[i] & ~((1U << (index & mask)) - 1);
+        if(word)
+            return i * BPI + __builtin_ctz(word);
+        for(i++; i < SIZE; i++)
+            if(_map[i])
+                return i * BPI + __builtin_ctz(_map[i]);
+        return -1;
+    }
+
 private:
      unsigned int _map[SIZE];
 };
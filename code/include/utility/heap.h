@@ -102,8 +102,8 @@ public:
 
 // Wrapper for atomic heap
 extern "C" {
-    void _heap_lock();
-    void _heap_unlock();
+    bool _heap_lock();
+    void _heap_unlock(bool was_locked);
 }
 
 template<typename T>
@@ -114,53 +114,213 @@ public:
     Heap_Wrapper(void * addr, unsigned int bytes): T(addr, bytes) {}
 
     bool empty() {
-        enter();
+        bool was_locked = enter();
         bool tmp = T::empty();
-        leave();
+        leave(was_locked);
         return tmp;
     }
 
     unsigned int size() {
-        enter();
+        bool was_locked = enter();
         unsigned int tmp = T::size();
-        leave();
+        leave(was_locked);
         return tmp;
     }
 
     void * alloc(unsigned int bytes) {
-        enter();
+        bool was_locked = enter();
         void * tmp = T::alloc(bytes);
-        leave();
+        leave(was_locked);
         return tmp;
     }
 
     void free(void * ptr) {
-        enter();
+        bool was_locked = enter();
         T::free(ptr);
-        leave();
+        leave(was_locked);
     }
 
     void free(void * ptr, unsigned int bytes) {
-        enter();
+        bool was_locked = enter();
         T::free(ptr, bytes);
-        leave();
+        leave(was_locked);
     }
 
 private:
-    void enter() { _heap_lock(); }
-    void leave() { _heap_unlock(); }
+    bool enter() { return _heap_lock(); }
+    void leave(bool was_locked) { _heap_unlock(was_locked); }
+};
+
+
+// Wrapper for uncached heap
+template<typename T, bool cached>
+class Slab_Wrapper: public T
+{
+public:
+    Slab_Wrapper() {}
+    Slab_Wrapper(void * addr, unsigned int bytes): T(addr, bytes) {}
+};
+
+
+// Wrapper for cached heap
+extern "C" {
+    bool _heap_cache_lock(unsigned int * cpu);
+    void _heap_cache_unlock(bool was_locked);
+}
+
+// Blocks of up to MAX_CACHED bytes come from size classes (powers of two from MIN_CACHED on). Each CPU keeps a
+// magazine of free blocks per class, which only it handles (with interrupts disabled), so most allocations and
+// frees take no lock. Refilling an empty magazine or draining a full one exchanges a batch of blocks with the
+// class' depot under the heap lock, and an empty depot carves a new slab out of the heap. Cached blocks carry the
+// same header as the heap's, with SLAB set in their size, so they are freed as any other. Slabs are never given
+// back to the heap.
+template<typename T>
+class Slab_Wrapper<T, true>: public T
+{
+private:
+    static const unsigned int CPUS = Traits<Build>::CPUS;
+    static const unsigned int CLASSES = 5;
+    static const unsigned int MIN_CACHED = 16;
+    static const unsigned int MAX_CACHED = MIN_CACHED << (CLASSES - 1);
+    static const unsigned int MAGAZINE = 32;    // free blocks per CPU and class
+    static const unsigned int BATCH = MAGAZINE / 2;
+    static const unsigned int HEADER = (T::typed ? sizeof(void *) : 0) + sizeof(int);
+    static const unsigned int SLAB = 0x80000000;
+
+    // Free blocks are linked through their first word
+    struct Block
+    {
+        Block * next;
+    };
+
+    struct List
+    {
+        List(): head(0), size(0) {}
+
+        void push(Block * b) { b->next = head; head = b; size++; }
+        Block * pop() { Block * b = head; head = b->next; size--; return b; }
+        void move(List * to, unsigned int n) { for(; n && head; n--) to->push(pop()); }
+
+        Block * head;
+        unsigned int size;
+    };
+
+public:
+    Slab_Wrapper() {}
+    Slab_Wrapper(void * addr, unsigned int bytes): T(addr, bytes) {}
+
+    void * alloc(unsigned int bytes) {
+        if(!bytes || (bytes > MAX_CACHED))
+            return T::alloc(bytes);
+
+        unsigned int c = size_class(bytes);
+
+        unsigned int cpu;
+        bool was_locked = _heap_cache_lock(&cpu);
+        if(_magazine[cpu][c].size) {
+            Block * b = _magazine[cpu][c].pop();
+            _heap_cache_unlock(was_locked);
+            return b;
+        }
+        _heap_cache_unlock(was_locked);
+
+        List batch;
+        was_locked = _heap_lock();
+        _depot[c].move(&batch, BATCH);
+        if(!batch.size)
+            carve(c, &batch);
+        _heap_unlock(was_locked);
+
+        if(!batch.size)
+            return 0;
+
+        Block * b = batch.pop();
+        was_locked = _heap_cache_lock(&cpu); // we might have migrated meanwhile, which doesn't matter
+        batch.move(&_magazine[cpu][c], batch.size);
+        _heap_cache_unlock(was_locked);
+
+        return b;
+    }
+
+    void free(void * ptr, unsigned int bytes) {
+        if(!(bytes & SLAB)) {
+            T::free(ptr, bytes);
+            return;
+        }
+
+        unsigned int c = size_class((bytes & ~SLAB) - HEADER);
+        Block * b = reinterpret_cast<Block *>(reinterpret_cast<char *>(ptr) + HEADER);
+
+        List batch;
+        unsigned int cpu;
+        bool was_locked = _heap_cache_lock(&cpu);
+        _magazine[cpu][c].push(b);
+        if(_magazine[cpu][c].size > MAGAZINE)
+            _magazine[cpu][c].move(&batch, BATCH);
+        _heap_cache_unlock(was_locked);
+
+        if(batch.size) {
+            was_locked = _heap_lock();
+            batch.move(&_depot[c], batch.size);
+            _heap_unlock(was_locked);
+        }
+    }
+
+private:
+    static unsigned int size_class(unsigned int bytes) {
+        unsigned int c = 0;
+        while((MIN_CACHED << c) < bytes)
+            c++;
+        return c;
+    }
+
+    // Called with the heap lock held, so it goes straight to Simple_Heap
+    void carve(unsigned int c, List * batch) {
+        unsigned int bytes = HEADER + (MIN_CACHED << c);
+        char * slab = reinterpret_cast<char *>(Simple_Heap::alloc(bytes * BATCH));
+        if(!slab)
+            return;
+
+        db<Heaps>(TRC) << "Heap::carve(this=" << this << ",class=" << (MIN_CACHED << c) << ") => " << reinterpret_cast<void *>(slab) << endl;
+
+        for(unsigned int i = 0; i < BATCH; i++, slab += bytes) {
+            int * addr = reinterpret_cast<int *>(slab);
+            if(T::typed)
+                *addr++ = reinterpret_cast<int>(static_cast<Simple_Heap *>(this));
+            *addr++ = bytes | SLAB;
+            batch->push(reinterpret_cast<Block *>(addr));
+        }
+    }
+
+private:
+    List _magazine[CPUS][CLASSES];
+    List _depot[CLASSES];
 };
 
 
 // Heap
-class Heap: public Heap_Wrapper<Simple_Heap, Traits<System>::multicore>
+class Heap: public Slab_Wrapper<Heap_Wrapper<Simple_Heap, Traits<System>::multicore>, Traits<System>::multicore>
 {
 private:
-    typedef Heap_Wrapper<Simple_Heap, Traits<System>::multicore> Base;
+    typedef Slab_Wrapper<Heap_Wrapper<Simple_Heap, Traits<System>::multicore>, Traits<System>::multicore> Base;
 
 public:
     Heap() {}
     Heap(void * addr, unsigned int bytes): Base(addr, bytes) {}
+
+    // Blocks are given back through the Heap, so they reach its caches and lock
+    static void typed_free(void * ptr) {
+        int * addr = reinterpret_cast<int *>(ptr);
+        unsigned int bytes = *--addr;
+        Heap * heap = static_cast<Heap *>(reinterpret_cast<Simple_Heap *>(*--addr));
+        heap->free(addr, bytes);
+    }
+
+    static void untyped_free(Heap * heap, void * ptr) {
+        int * addr = reinterpret_cast<int *>(ptr);
+        unsigned int bytes = *--addr;
+        heap->free(addr, bytes);
+    }
 };
 
 __END_UTIL
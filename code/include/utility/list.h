@@ -4,6 +4,7 @@
 #define __list_h
 
 #include <system/config.h>
+#include "bitmap.h"
 
 __BEGIN_UTIL
 
@@ -231,6 +232,88 @@ namespace List_Elements
         Element * _next;
     };
 
+    // Heap Scheduling Element
+    // For Pairing_Heap, "next" is the right sibling and "prev" is either the
+    // left sibling or, for leftmost children, the parent. "stamp" orders
+    // elements with the same rank by insertion, as in ordered lists.
+    // Works as a Doubly_Linked_Scheduling element when in a list.
+    template<typename T, typename R = Rank>
+    class Heap_Scheduling
+    {
+    public:
+        typedef T Object_Type;
+        typedef Rank Rank_Type;
+        typedef Heap_Scheduling Element;
+
+    public:
+        Heap_Scheduling(const T * o,  const R & r = 0): _object(o), _rank(r), _prev(0), _next(0), _child(0), _stamp(0) {}
+
+        T * object() const { return const_cast<T *>(_object); }
+
+        Element * prev() const { return _prev; }
+        Element * next() const { return _next; }
+        Element * child() const { return _child; }
+        void prev(Element * e) { _prev = e; }
+        void next(Element * e) { _next = e; }
+        void child(Element * e) { _child = e; }
+
+        unsigned int stamp() const { return _stamp; }
+        void stamp(unsigned int s) { _stamp = s; }
+
+        const R & rank() const { return _rank; }
+        void rank(const R & r) { _rank = r; }
+        int promote(const R & n = 1) { _rank -= n; return _rank; }
+        int demote(const R & n = 1) { _rank += n; return _rank; }
+
+    private:
+        const T * _object;
+        R _rank;
+        Element * _prev;
+        Element * _next;
+        Element * _child;
+        unsigned int _stamp;
+    };
+
+
+    // Timing Wheel Element
+    // "rank" is the number of ticks to expiry at insertion, while "expiry"
+    // (an absolute tick) and "slot" are kept by the wheel
+    template<typename T, typename R = Rank>
+    class Doubly_Linked_Timed
+    {
+    public:
+        typedef T Object_Type;
+        typedef Rank Rank_Type;
+        typedef Doubly_Linked_Timed Element;
+
+    public:
+        Doubly_Linked_Timed(const T * o,  const R & r = 0): _object(o), _rank(r), _prev(0), _next(0), _expiry(0), _slot(~0U) {}
+
+        T * object() const { return const_cast<T *>(_object); }
+
+        Element * prev() const { return _prev; }
+        Element * next() const { return _next; }
+        void prev(Element * e) { _prev = e; }
+        void next(Element * e) { _next = e; }
+
+        const R & rank() const { return _rank; }
+        void rank(const R & r) { _rank = r; }
+
+        unsigned int expiry() const { return _expiry; }
+        void expiry(unsigned int e) { _expiry = e; }
+
+        unsigned int slot() const { return _slot; }
+        void slot(unsigned int s) { _slot = s; }
+
+    private:
+        const T * _object;
+        R _rank;
+        Element * _prev;
+        Element * _next;
+        unsigned int _expiry;
+        unsigned int _slot;
+    };
+
 
     // Grouping List Element
     template<typename T>
@@ -327,6 +410,51 @@ namespace List_Iterators
     private:
         Element * _current;
     };
+
+    // Preorder Iterator (for heaps, see Pairing_Heap)
+    template<typename El>
+    class Preorder
+    {
+    private:
+        typedef Preorder<El> Iterator;
+
+    public:
+        typedef El Element;
+
+    public:
+        Preorder(): _current(0) {}
+        Preorder(Element * e): _current(e) {}
+
+        operator Element *() const { return _current; }
+
+        Element & operator*() const { return *_current; }
+        Element * operator->() const { return _current; }
+
+        Iterator & operator++() {
+            if(_current->child())
+                _current = _current->child();
+            else {
+                while(_current && !_current->next())
+                    _current = parent(_current);
+                if(_current)
+                    _current = _current->next();
+            }
+            return *this;
+        }
+        Iterator operator++(int) { Iterator tmp = *this; ++*this; return tmp; }
+
+        bool operator==(const Iterator & i) const { return _current == i._current; }
+        bool operator!=(const Iterator & i) const { return _current != i._current; }
+
+    private:
+        static Element * parent(Element * e) {
+            for(; e->prev() && (e->prev()->child() != e); e = e->prev());
+            return e->prev();
+        }
+
+    private:
+        Element * _current;
+    };
 }
 
 // Singly-Linked List
@@ -986,6 +1114,313 @@ template<typename T,
 class Relative_List: public Ordered_List<T, R, El, true> {};
 
 
+// Pairing Heap
+// Intrusive, min-ordered heap with the interface of Ordered_List that matters
+// to scheduling lists: insert() is O(1), while remove() and remove(e) are
+// O(log n) amortized. Elements of equal rank leave the heap in the order they
+// entered it (FIFO), just like in Ordered_List. Iteration is in preorder, so
+// only begin() is guaranteed to yield the minimum.
+template<typename T,
+          typename R = List_Element_Rank,
+          typename El = List_Elements::Heap_Scheduling<T, R> >
+class Pairing_Heap
+{
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+    typedef List_Iterators::Preorder<El> Iterator;
+
+public:
+    Pairing_Heap(): _size(0), _stamp(0), _root(0) {}
+
+    bool empty() const { return (_size == 0); }
+    unsigned int size() const { return _size; }
+
+    Element * head() { return _root; }
+
+    Iterator begin() { return Iterator(_root); }
+    Iterator end() { return Iterator(0); }
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Pairing_Heap::insert(e=" << e << ",r=" << e->rank() << ")" << endl;
+
+        e->stamp(_stamp++);
+        e->prev(0);
+        e->next(0);
+        e->child(0);
+
+        _root = _root ? meld(_root, e) : e;
+        _size++;
+    }
+
+    Element * remove() { return remove_head(); }
+
+    Element * remove_head() {
+        db<Lists>(TRC) << "Pairing_Heap::remove_head()" << endl;
+
+        Element * e = _root;
+        if(e) {
+            _root = merge(e->child());
+            e->child(0);
+            _size--;
+        }
+        return e;
+    }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Pairing_Heap::remove(e=" << e << ")" << endl;
+
+        if(e == _root)
+            return remove_head();
+
+        if(e->prev()->child() == e)
+            e->prev()->child(e->next());
+        else
+            e->prev()->next(e->next());
+        if(e->next())
+            e->next()->prev(e->prev());
+        e->prev(0);
+        e->next(0);
+
+        Element * subheap = merge(e->child());
+        e->child(0);
+        if(subheap)
+            _root = meld(_root, subheap);
+        _size--;
+
+        return e;
+    }
+
+private:
+    // Strict order: by rank, then by insertion
+    static bool before(const Element * a, const Element * b) {
+        return (a->rank() < b->rank()) || ((a->rank() == b->rank()) && (static_cast<int>(a->stamp() - b->stamp()) < 0));
+    }
+
+    // Both "a" and "b" must be roots (i.e. have no siblings)
+    static Element * meld(Element * a, Element * b) {
+        if(before(b, a)) {
+            Element * tmp = a;
+            a = b;
+            b = tmp;
+        }
+
+        b->prev(a);
+        b->next(a->child());
+        if(a->child())
+            a->child()->prev(b);
+        a->child(b);
+
+        return a;
+    }
+
+    // Standard two-pass pairing of a list of siblings into a single heap
+    static Element * merge(Element * first) {
+        if(!first)
+            return 0;
+
+        // Left to right, meld pairs, chaining the results backwards through "next"
+        Element * chain = 0;
+        while(first) {
+            Element * a = first;
+            Element * b = a->next();
+            first = b ? b->next() : 0;
+
+            a->prev(0);
+            a->next(0);
+            if(b) {
+                b->prev(0);
+                b->next(0);
+                a = meld(a, b);
+            }
+
+            a->next(chain);
+            chain = a;
+        }
+
+        // Right to left, meld each pair into the accumulated heap
+        Element * root = chain;
+        chain = chain->next();
+        root->next(0);
+        while(chain) {
+            Element * a = chain;
+            chain = chain->next();
+            a->next(0);
+            root = meld(root, a);
+        }
+
+        return root;
+    }
+
+private:
+    unsigned int _size;
+    unsigned int _stamp;
+    Element * _root;
+};
+
+
+// Hierarchical Timing Wheel
+// Elements are kept in LEVELS wheels of 2^BITS slots each, a slot of level l
+// spanning 2^(BITS*l) ticks, and are inserted to expire "rank" ticks from now
+// (at the rank-th call to tick()). Both insert() and remove(e) are O(1), since
+// each element records its slot. tick() cascades the current slot of every
+// level whose lower levels have just wrapped around into them, and then moves
+// all elements due at that tick at once to an expired list, from where
+// remove_expired() takes them one at a time. Elements beyond the span of the
+// wheel are parked in its farthest slot and cascaded until they fit.
+template<typename T,
+          typename R = List_Element_Rank,
+          typename El = List_Elements::Doubly_Linked_Timed<T, R>,
+          unsigned int BITS = 6,
+          unsigned int LEVELS = 4>
+class Timing_Wheel
+{
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+
+    static const unsigned int SLOTS = 1 << BITS;
+    static const unsigned int SPAN = 1 << (BITS * LEVELS); // ticks
+
+private:
+    static const unsigned int MASK = SLOTS - 1;
+    static const unsigned int EXPIRED = LEVELS * SLOTS;
+    static const unsigned int NONE = ~0U;
+
+    typedef List<T, El> Slot;
+
+public:
+    Timing_Wheel(): _size(0), _now(0) {}
+
+    bool empty() const { return (_size == 0); }
+    unsigned int size() const { return _size; } // including expired elements not yet removed
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Timing_Wheel::insert(e=" << e << ",r=" << e->rank() << ")" << endl;
+
+        e->expiry((e->rank() > 0) ? _now + e->rank() - 1 : _now);
+        place(e);
+        _size++;
+    }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Timing_Wheel::remove(e=" << e << ",s=" << e->slot() << ")" << endl;
+
+        if(e->slot() == NONE)
+            return 0;
+
+        if(e->slot() == EXPIRED)
+            _expired.remove(e);
+        else {
+            _slot[e->slot()].remove(e);
+            if(_slot[e->slot()].empty())
+                _map[e->slot() / SLOTS].reset(e->slot() & MASK);
+        }
+        e->slot(NONE);
+        _size--;
+
+        return e;
+    }
+
+    Element * remove_expired() {
+        Element * e = _expired.remove_head();
+        if(e) {
+            e->slot(NONE);
+            _size--;
+        }
+        return e;
+    }
+
+    void tick() {
+        for(unsigned int l = 1; (l < LEVELS) && !((_now >> (BITS * (l - 1))) & MASK); l++)
+            cascade(l, (_now >> (BITS * l)) & MASK);
+
+        unsigned int index = _now & MASK;
+        while(Element * e = _slot[index].remove_head()) {
+            e->slot(EXPIRED);
+            _expired.insert(e);
+        }
+        _map[0].reset(index);
+
+        _now++;
+    }
+
+    // Calls to tick() until the next expiry (or at least until the next cascade, which might bring
+    // elements due right away), 0 if elements have already expired and ~0U if the wheel is empty
+    unsigned int next() const {
+        if(!_expired.empty())
+            return 0;
+        if(!_size)
+            return ~0U;
+
+        unsigned int index = _now & MASK;
+        unsigned int ticks = ~0U;
+
+        int slot = _map[0].next(index);
+        if((slot < 0) && ((slot = _map[0].next(0)) >= 0))
+            slot += SLOTS;
+        if(slot >= 0)
+            ticks = slot - index + 1;
+
+        for(unsigned int l = 1; l < LEVELS; l++)
+            if(!_map[l].empty()) {
+                unsigned int cascade = index ? SLOTS - index + 1 : 1;
+                if(cascade < ticks)
+                    ticks = cascade;
+                break;
+            }
+
+        return ticks;
+    }
+
+private:
+    // Level 0 slots hold one tick each, so their elements need no ordering
+    void place(Element * e) {
+        unsigned int delta = e->expiry() - _now;
+        if(static_cast<int>(delta) < 0) { // overdue, goes to the current slot
+            e->expiry(_now);
+            delta = 0;
+        }
+
+        unsigned int expiry = e->expiry();
+        if(delta >= SPAN) {
+            delta = SPAN - 1;
+            expiry = _now + delta;
+        }
+
+        unsigned int l = 0;
+        while((l < LEVELS - 1) && (delta >= (1U << (BITS * (l + 1)))))
+            l++;
+
+        unsigned int slot = l * SLOTS + ((expiry >> (BITS * l)) & MASK);
+        e->slot(slot);
+        _slot[slot].insert(e);
+        _map[l].set(slot & MASK);
+    }
+
+    void cascade(unsigned int level, unsigned int index) {
+        Slot & slot = _slot[level * SLOTS + index];
+        if(slot.empty())
+            return;
+
+        db<Lists>(TRC) << "Timing_Wheel::cascade(l=" << level << ",i=" << index << ",n=" << slot.size() << ")" << endl;
+
+        _map[level].reset(index);
+        while(Element * e = slot.remove_head())
+            place(e);
+    }
+
+private:
+    unsigned int _size;
+    unsigned int _now; // the tick the next call to tick() stands for
+    Slot _slot[LEVELS * SLOTS];
+    Slot _expired;
+    Bitmap<SLOTS> _map[LEVELS]; // non-empty slots of each level
+};
+
+
 // Doubly-Linked, Scheduling List
 // Objects subject to scheduling must export a type "Criterion" compatible
 // with those available at scheduler.h .
@@ -1088,6 +1523,190 @@ private:
 };
 
 
+// Doubly-Linked, Rank-Indexed Scheduling List
+// Same contract as Scheduling_List, for criteria with fixed priorities. The
+// distinct ranks in the list (up to LEVELS of them) are kept sorted in a small
+// index, each with the last element of that rank, so RM and DM get a level per
+// period or deadline however many threads share it. Insertions go right after
+// the last element of their rank or, for a new rank, after that of the nearest
+// higher-priority level, found by binary search. Equal ranks thus stay FIFO,
+// as in Scheduling_List, and insertion takes O(log LEVELS) steps, plus O(LEVELS)
+// to open or close a level, regardless of the number of elements. Ranks beyond
+// the first LEVELS distinct ones are not indexed and are reached by walking
+// from the nearest level. The list itself stays ordered, so head(), tail() and
+// iterators work as usual. Ranks must not change while elements are in the list.
+template<typename T,
+          typename R = typename T::Criterion,
+          typename El = List_Elements::Doubly_Linked_Scheduling<T, R> >
+class Indexed_Scheduling_List: private List<T, El>
+{
+private:
+    typedef List<T, El> Base;
+
+    static const unsigned int LEVELS = 32;
+
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+    typedef typename Base::Iterator Iterator;
+
+public:
+    Indexed_Scheduling_List(): _chosen(0), _levels(0) {}
+
+    using Base::empty;
+    using Base::size;
+    using Base::head;
+    using Base::tail;
+    using Base::begin;
+    using Base::end;
+
+    Element * volatile & chosen() { return _chosen; }
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Indexed_Scheduling_List::insert(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(_chosen)
+            enqueue(e);
+        else
+            _chosen = e;
+    }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Indexed_Scheduling_List::remove(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(e == _chosen)
+            _chosen = dequeue();
+        else
+            e = dequeue(e);
+
+        return e;
+    }
+
+    Element * choose() {
+        db<Lists>(TRC) << "Indexed_Scheduling_List::choose()" << endl;
+
+        if(!empty()) {
+            enqueue(_chosen);
+            _chosen = dequeue();
+        }
+
+        return _chosen;
+    }
+
+    Element * choose_another() {
+        db<Lists>(TRC) << "Indexed_Scheduling_List::choose_another()" << endl;
+
+        if(!empty() && head()->rank() != R::IDLE) {
+            Element * tmp = _chosen;
+            _chosen = dequeue();
+            enqueue(tmp);
+        }
+
+        return _chosen;
+    }
+
+    Element * choose(Element * e) {
+        db<Lists>(TRC) << "Indexed_Scheduling_List::choose(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(e != _chosen) {
+            enqueue(_chosen);
+            _chosen = dequeue(e);
+        }
+
+        return _chosen;
+    }
+
+private:
+    // Index of the first level whose rank is not lower than "rank"
+    unsigned int level(int rank) {
+        unsigned int l = 0;
+        unsigned int h = _levels;
+        while(l < h) {
+            unsigned int m = (l + h) / 2;
+            if(_rank[m] < rank)
+                l = m + 1;
+            else
+                h = m;
+        }
+        return l;
+    }
+
+    void enqueue(Element * e) {
+        int rank = e->rank();
+        unsigned int l = level(rank);
+        Element * prev;
+
+        if((l < _levels) && (_rank[l] == rank)) {
+            prev = _last[l];
+            _last[l] = e;
+        } else {
+            // Unindexed elements of this or higher-priority ranks may follow the nearest level
+            prev = l ? _last[l - 1] : 0;
+            for(Element * next = prev ? prev->next() : head(); next && (next->rank() <= rank); next = next->next())
+                prev = next;
+
+            if(_levels < LEVELS) {
+                for(unsigned int i = _levels; i > l; i--) {
+                    _rank[i] = _rank[i - 1];
+                    _last[i] = _last[i - 1];
+                }
+                _rank[l] = rank;
+                _last[l] = e;
+                _levels++;
+            }
+        }
+
+        if(!prev)
+            Base::insert_head(e);
+        else if(prev == tail())
+            Base::insert_tail(e);
+        else
+            Base::insert(e, prev, prev->next());
+    }
+
+    Element * dequeue() { return empty() ? 0 : dequeue(head()); }
+
+    Element * dequeue(Element * e) {
+        int rank = e->rank();
+        unsigned int l = level(rank);
+
+        if((l < _levels) && (_last[l] == e)) {
+            Element * prev = e->prev();
+            if(prev && (prev->rank() == rank))
+                _last[l] = prev;
+            else {
+                _levels--;
+                for(unsigned int i = l; i < _levels; i++) {
+                    _rank[i] = _rank[i + 1];
+                    _last[i] = _last[i + 1];
+                }
+            }
+        }
+
+        return Base::remove(e);
+    }
+
+private:
+    Element * volatile _chosen;
+    unsigned int _levels;
+    int _rank[LEVELS];
+    Element * _last[LEVELS];
+};
+
+
 // Doubly-Linked, Multihead Scheduling List
 // Besides declaring "Criterion", objects subject to scheduling policies that
 // use the Multihead list must export the HEADS constant to indicate the
@@ -1198,6 +1817,210 @@ private:
 };
 
 
+// Heap-Ordered Scheduling List
+// Same contract as Scheduling_List, but kept in a Pairing_Heap, so insertions
+// are O(1) and removals O(log n) amortized instead of O(n). Meant for criteria
+// whose priorities change at every job release (e.g. EDF). head() is the
+// highest-priority element waiting; iteration covers all elements, but not
+// in priority order.
+template<typename T,
+          typename R = typename T::Criterion,
+          typename El = List_Elements::Heap_Scheduling<T, R> >
+class Heap_Scheduling_List: private Pairing_Heap<T, R, El>
+{
+private:
+    typedef Pairing_Heap<T, R, El> Base;
+
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+    typedef typename Base::Iterator Iterator;
+
+public:
+    Heap_Scheduling_List(): _chosen(0) {}
+
+    using Base::empty;
+    using Base::size;
+    using Base::head;
+    using Base::begin;
+    using Base::end;
+
+    Element * volatile & chosen() { return _chosen; }
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Heap_Scheduling_List::insert(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(_chosen)
+            Base::insert(e);
+        else
+            _chosen = e;
+    }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Heap_Scheduling_List::remove(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(e == _chosen)
+            _chosen = Base::remove_head();
+        else
+            e = Base::remove(e);
+
+        return e;
+    }
+
+    Element * choose() {
+        db<Lists>(TRC) << "Heap_Scheduling_List::choose()" << endl;
+
+        if(!empty()) {
+            Base::insert(_chosen);
+            _chosen = Base::remove_head();
+        }
+
+        return _chosen;
+    }
+
+    Element * choose_another() {
+        db<Lists>(TRC) << "Heap_Scheduling_List::choose_another()" << endl;
+
+        if(!empty() && head()->rank() != R::IDLE) {
+            Element * tmp = _chosen;
+            _chosen = Base::remove_head();
+            Base::insert(tmp);
+        }
+
+        return _chosen;
+    }
+
+    Element * choose(Element * e) {
+        db<Lists>(TRC) << "Heap_Scheduling_List::choose(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(e != _chosen) {
+            Base::insert(_chosen);
+            _chosen = Base::remove(e);
+        }
+
+        return _chosen;
+    }
+
+private:
+    Element * volatile _chosen;
+};
+
+
+// Heap-Ordered Multihead Scheduling List
+// Multihead_Scheduling_List kept in a Pairing_Heap (see Heap_Scheduling_List).
+template<typename T,
+          typename R = typename T::Criterion,
+          typename El = List_Elements::Heap_Scheduling<T, R>,
+          unsigned int H = R::HEADS>
+class Multihead_Heap_Scheduling_List: private Pairing_Heap<T, R, El>
+{
+private:
+    typedef Pairing_Heap<T, R, El> Base;
+
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+    typedef typename Base::Iterator Iterator;
+
+public:
+    Multihead_Heap_Scheduling_List() {
+        for(unsigned int i = 0; i < H; i++)
+            _chosen[i] = 0;
+    }
+
+    using Base::empty;
+    using Base::size;
+    using Base::head;
+    using Base::begin;
+    using Base::end;
+
+    Element * volatile & chosen() { return _chosen[R::current_head()]; }
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Multihead_Heap_Scheduling_List::insert(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(_chosen[R::current_head()])
+            Base::insert(e);
+        else
+            _chosen[R::current_head()] = e;
+    }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Multihead_Heap_Scheduling_List::remove(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(e == _chosen[R::current_head()])
+            _chosen[R::current_head()] = Base::remove_head();
+        else
+            e = Base::remove(e);
+
+        return e;
+    }
+
+    Element * choose() {
+        db<Lists>(TRC) << "Multihead_Heap_Scheduling_List::choose()" << endl;
+
+        if(!empty()) {
+            Base::insert(_chosen[R::current_head()]);
+            _chosen[R::current_head()] = Base::remove_head();
+        }
+
+        return _chosen[R::current_head()];
+    }
+
+    Element * choose_another() {
+        db<Lists>(TRC) << "Multihead_Heap_Scheduling_List::choose_another()" << endl;
+
+        if(!empty() && head()->rank() != R::IDLE) {
+            Element * tmp = _chosen[R::current_head()];
+            _chosen[R::current_head()] = Base::remove_head();
+            Base::insert(tmp);
+        }
+
+        return _chosen[R::current_head()];
+    }
+
+    Element * choose(Element * e) {
+        db<Lists>(TRC) << "Multihead_Heap_Scheduling_List::choose(e=" << e
+                       << ") => {p=" << (e ? e->prev() : (void *) -1)
+                       << ",o=" << (e ? e->object() : (void *) -1)
+                       << ",n=" << (e ? e->next() : (void *) -1)
+                       << "}" << endl;
+
+        if(e != _chosen[R::current_head()]) {
+            Base::insert(_chosen[R::current_head()]);
+            _chosen[R::current_head()] = Base::remove(e);
+        }
+
+        return _chosen[R::current_head()];
+    }
+
+private:
+    Element * volatile _chosen[H];
+};
+
+
 // Doubly-Linked, Scheduling Multilist
 // Besides declaring "Criterion", objects subject to scheduling policies that
 // use the Multilist must export the QUEUES constant to indicate the number of
@@ -1233,6 +2056,12 @@ public:
     Element * head() { return _list[R::current_queue()].head(); }
     Element * tail() { return _list[R::current_queue()].tail(); }
 
+    // Access to other queues (e.g. for migration)
+    unsigned int size(unsigned int queue) const { return _list[queue].size(); }
+    Element * head(unsigned int queue) { return _list[queue].head(); }
+    Iterator begin(unsigned int queue) { return _list[queue].begin(); }
+    Element * remove(Element * e, unsigned int queue) { return _list[queue].remove(e); }
+
     Iterator begin() { return Iterator(_list[R::current_queue()].head()); }
     Iterator end() { return Iterator(0); }
 
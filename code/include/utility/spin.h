@@ -1,5 +1,15 @@
 // EPOS Spin Lock Utility Declarations
 
+// Three algorithms are available, selected through Traits<Spin>:
+// TAS spins on an atomic instruction over a single word. It is the cheapest when uncontended,
+//     but all waiters hammer the same cache line and nothing keeps one CPU from starving the others.
+// TICKET takes a ticket with a single fetch-and-add and then only reads the turn, so waiters share
+//     the line but no longer write to it, and the lock is granted in FIFO order.
+// MCS queues waiters on per-CPU nodes, each spinning on its own flag, so a release only touches
+//     the next waiter's node. Since nodes are per CPU, MCS locks must be acquired with interrupts
+//     disabled (as the kernel always does) and thus cannot be used in user mode.
+// Recursive locks (Spin) keep the owner's thread id and a level in front of the flat ones.
+
 #ifndef __spin_h
 #define __spin_h
 
@@ -7,22 +17,23 @@
 
 __BEGIN_UTIL
 
-// Forwarder to the running thread id
+// Forwarder to the running thread id and to the CPU it runs on
 class This_Thread
 {
 public:
     static unsigned int id();
+    static unsigned int cpu();
     static void not_booting() { _not_booting = true; }
 
 private:
     static bool _not_booting;
 };
 
-// Recursive Spin Lock
-class Spin
+// Recursive Test-and-Set Spin Lock
+class Recursive_TAS_Spin
 {
 public:
-    Spin(): _level(0), _owner(0) {}
+    Recursive_TAS_Spin(): _level(0), _owner(0) {}
 
     void acquire() {
         int me = This_Thread::id();
@@ -45,11 +56,11 @@ private:
     volatile int _owner;
 };
 
-// Flat Spin Lock
-class Simple_Spin
+// Flat Test-and-Set Spin Lock
+class TAS_Spin
 {
 public:
-    Simple_Spin(): _locked(false) {}
+    TAS_Spin(): _locked(false) {}
 
     void acquire() {
         while(CPU::tsl(_locked));
@@ -68,6 +79,148 @@ private:
     volatile bool _locked;
 };
 
+// Flat Ticket Spin Lock
+class Ticket_Spin
+{
+public:
+    Ticket_Spin(): _next(0), _serving(0) {}
+
+    void acquire() {
+        int ticket = CPU::finc(_next);
+        while(_serving != ticket);
+
+        db<Spin>(TRC) << "Spin::acquire[SPIN=" << this << "]() => {ticket=" << ticket << "}" << endl;
+    }
+
+    // Only the holder writes _serving
+    void release() {
+        _serving = _serving + 1;
+
+        db<Spin>(TRC) << "Spin::release[SPIN=" << this << "]() => {serving=" << _serving << "}" << endl;
+    }
+
+private:
+    volatile int _next;
+    volatile int _serving;
+};
+
+// Flat MCS Spin Lock
+// Nodes and the queue's tail are CPU ids + 1, 0 meaning none
+class MCS_Spin
+{
+private:
+    static const unsigned int CPUS = Traits<Build>::CPUS;
+
+    struct Node
+    {
+        volatile int next;
+        volatile bool waiting;
+    };
+
+public:
+    MCS_Spin(): _tail(0) {
+        for(unsigned int i = 0; i < CPUS; i++) {
+            _node[i].next = 0;
+            _node[i].waiting = false;
+        }
+    }
+
+    void acquire() {
+        int me = This_Thread::cpu() + 1;
+        Node & node = _node[me - 1];
+
+        node.next = 0;
+        node.waiting = true;
+
+        int predecessor;
+        do
+            predecessor = _tail;
+        while(CPU::cas(_tail, predecessor, me) != predecessor);
+
+        if(predecessor) {
+            _node[predecessor - 1].next = me;
+            while(node.waiting);
+        }
+
+        db<Spin>(TRC) << "Spin::acquire[SPIN=" << this << "]() => {predecessor=" << predecessor - 1 << "}" << endl;
+    }
+
+    // A successor may be between taking the tail and linking itself, in which case we wait for it
+    void release() {
+        int me = This_Thread::cpu() + 1;
+        Node & node = _node[me - 1];
+
+        if(!node.next) {
+            if(CPU::cas(_tail, me, 0) == me) {
+                db<Spin>(TRC) << "Spin::release[SPIN=" << this << "]() => {successor=-1}" << endl;
+                return;
+            }
+            while(!node.next);
+        }
+        _node[node.next - 1].waiting = false;
+
+        db<Spin>(TRC) << "Spin::release[SPIN=" << this << "]() => {successor=" << node.next - 1 << "}" << endl;
+    }
+
+private:
+    volatile int _tail;
+    Node _node[CPUS];
+};
+
+// Recursive Spin Lock on top of a flat one
+// As with Recursive_TAS_Spin, the thread releasing the lock needs not be the one that acquired it (see Thread::dispatch())
+template<typename Flat>
+class Recursive_Spin
+{
+public:
+    Recursive_Spin(): _level(0), _owner(0) {}
+
+    void acquire() {
+        int me = This_Thread::id();
+
+        if(_owner != me) {
+            _lock.acquire();
+            _owner = me;
+        }
+        _level++;
+
+        db<Spin>(TRC) << "Spin::acquire[SPIN=" << this << ",ID=" << me << "]() => {owner=" << _owner << ",level=" << _level << "}" << endl;
+    }
+
+    void release() {
+        if((_level > 0) && (--_level == 0)) {
+            _owner = 0;
+            _lock.release();
+        }
+
+        db<Spin>(TRC) << "Spin::release[SPIN=" << this << "]() => {owner=" << _owner << ",level=" << _level << "}" << endl;
+    }
+
+private:
+    volatile int _level;
+    volatile int _owner;
+    Flat _lock;
+};
+
+// Locks as configured in Traits<Spin>
+template<unsigned int ALGORITHM>
+struct Select_Spin
+{
+    typedef typename IF<ALGORITHM == Traits<Spin>::TICKET, Ticket_Spin,
+                        typename IF<ALGORITHM == Traits<Spin>::MCS, MCS_Spin, TAS_Spin>::Result>::Result Flat;
+
+    typedef typename IF<ALGORITHM == Traits<Spin>::TAS, Recursive_TAS_Spin, Recursive_Spin<Flat> >::Result Recursive;
+};
+
+// Recursive Spin Lock (e.g. Thread's scheduler locks)
+class Spin: public Select_Spin<Traits<Spin>::RECURSIVE>::Recursive {};
+
+// Flat Spin Lock (e.g. synchronizers and Alarm)
+class Simple_Spin: public Select_Spin<Traits<Spin>::SIMPLE>::Flat {};
+
+// Recursive Spin Lock of the system's heaps
+class Heap_Spin: public Select_Spin<Traits<Spin>::HEAP>::Recursive {};
+
 __END_UTIL
 
 #endif
@@ -10,6 +10,9 @@ __BEGIN_SYS
 // Class attributes
 unsigned int CPU::_cpu_clock;
 unsigned int CPU::_bus_clock;
+CPU::Ratio CPU::_min_ratio;
+CPU::Ratio CPU::_max_ratio;
+bool CPU::_effective;
 
 // Class methods
 void CPU::Context::save() volatile
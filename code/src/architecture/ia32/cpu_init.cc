@@ -16,6 +16,47 @@ void CPU::init()
     _cpu_clock = System::info()->tm.cpu_clock;
     _bus_clock = System::info()->tm.bus_clock;
 
+    Reg32 eax, ebx, ecx, edx;
+    ecx = 0;
+    cpuid(0, &eax, &ebx, &ecx, &edx);
+    Reg32 max_leaf = eax;
+
+    // Enumerate the P-states (Enhanced Intel SpeedStep)
+    ecx = 0;
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    _min_ratio = _max_ratio = 0;
+    if(Traits<DVFS>::enabled && (ecx & CPUID_EIST)) {
+        wrmsr(IA32_MISC_ENABLE, rdmsr(IA32_MISC_ENABLE) | MISC_ENABLE_EIST);
+
+        // MSR_PLATFORM_INFO is not architectural: it came with Nehalem (and it faults on Core 2 and the early Atoms)
+        unsigned int family = (eax >> 8) & 0xf;
+        unsigned int model = ((eax >> 4) & 0xf) | ((family == 6) ? ((eax >> 16) & 0xf) << 4 : 0);
+        bool platform_info = (family == 6) && (model >= 0x1a) && (model != 0x1c) && (model != 0x1d)
+                             && (model != 0x26) && (model != 0x27) && (model != 0x35) && (model != 0x36);
+        if(platform_info) {
+            Reg64 platform = rdmsr(MSR_PLATFORM_INFO);
+            _max_ratio = (platform >> 8) & 0xff;  // maximum non-turbo ratio
+            _min_ratio = (platform >> 40) & 0xff; // maximum efficiency ratio
+        } else
+            _max_ratio = (rdmsr(IA32_PERF_STATUS) >> 40) & 0x1f; // maximum bus ratio on earlier parts
+        if(!_max_ratio)
+            _max_ratio = (rdmsr(IA32_PERF_STATUS) >> 8) & 0xff;
+        if(!_min_ratio || (_min_ratio > _max_ratio))
+            _min_ratio = _max_ratio;
+        db<Init, CPU>(INF) << "CPU::init: P-states={min=" << _min_ratio << ",max=" << _max_ratio << "}" << endl;
+    } else if(Traits<DVFS>::enabled)
+        db<Init, CPU>(WRN) << "CPU::init: P-states are not available, DVFS will rely on clock modulation!" << endl;
+
+    // Enumerate the effective frequency counters, used to measure the clock actually delivered (see DVFS::measure())
+    _effective = false;
+    if(max_leaf >= 6) {
+        ecx = 0;
+        cpuid(6, &eax, &ebx, &ecx, &edx);
+        _effective = ecx & CPUID_APERFMPERF;
+    }
+    if(!_effective)
+        db<Init, CPU>(WRN) << "CPU::init: IA32_APERF/IA32_MPERF are not available, effective clocks are assumed to be the requested ones!" << endl;
+
     // Initialize the MMU
     if(Traits<MMU>::enabled)
         MMU::init();
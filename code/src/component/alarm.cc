@@ -9,50 +9,95 @@ __BEGIN_SYS
 // Class attributes
 Alarm_Timer * Alarm::_timer;
 volatile Alarm::Tick Alarm::_elapsed;
-Alarm::Queue Alarm::_request;
+Precise_Timer * Alarm::_precise_timer;
+Alarm::Queue Alarm::_request[Alarm::CPUS];
+Alarm::Precise_Queue Alarm::_precise[Alarm::CPUS];
+Simple_Spin Alarm::_lock[Alarm::CPUS];
 
 
 // Methods
-Alarm::Alarm(const Microsecond & time, Handler * handler, int times)
-: _time(time), _handler(handler), _times(times), _ticks(ticks(time)), _link(this, _ticks)
+Alarm::Alarm(const Microsecond & time, Handler * handler, int times, int cpu)
+: _time(time), _handler(handler), _times(times), _ticks(ticks(time)),
+  _cpu(((cpu == ANY) || (static_cast<unsigned int>(cpu) >= Machine::n_cpus())) ? Machine::cpu_id() : cpu),
+  _interval(0), _link(this, _ticks), _precise_link(this, 0)
 {
-    lock();
+    db<Alarm>(TRC) << "Alarm(t=" << time << ",tk=" << _ticks << ",h=" << reinterpret_cast<void *>(handler) << ",x=" << times << ",cpu=" << _cpu << ") => " << this << endl;
 
-    db<Alarm>(TRC) << "Alarm(t=" << time << ",tk=" << _ticks << ",h=" << reinterpret_cast<void *>(handler) << ",x=" << times << ") => " << this << endl;
+    start();
+}
+
+
+Alarm::Alarm(const Nanosecond & time, Handler * handler, int times, int cpu)
+: _time(time / 1000), _handler(handler), _times(times), _ticks(ticks(_time)),
+  _cpu(((cpu == ANY) || (static_cast<unsigned int>(cpu) >= Machine::n_cpus())) ? Machine::cpu_id() : cpu),
+  _interval(Timer::high_resolution ? cycles(time) : 0), _link(this, _ticks), _precise_link(this, 0)
+{
+    db<Alarm>(TRC) << "Alarm(t=" << time << "ns,c=" << _interval << ",h=" << reinterpret_cast<void *>(handler) << ",x=" << times << ",cpu=" << _cpu << ") => " << this << endl;
+
+    start();
+}
 
-    if(_ticks) {
-        _request.insert(&_link);
-        unlock();
+
+void Alarm::start()
+{
+    lock(_cpu);
+
+    if(_interval) {
+        _precise_link.rank(TSC::time_stamp() + _interval);
+        _precise[_cpu].insert(&_precise_link);
+        if((_cpu == Machine::cpu_id()) && (_precise[_cpu].head() == &_precise_link))
+            Timer::precise(_precise_link.rank());
+        unlock(_cpu);
+        Timer::wakeup(_cpu);
+    } else if(_ticks) {
+        _request[_cpu].insert(&_link);
+        unlock(_cpu);
+        Timer::wakeup(_cpu);
     } else {
-        unlock();
-        (*handler)();
+        unlock(_cpu);
+        (*_handler)();
     }
 }
 
 
 Alarm::~Alarm()
 {
-    lock();
+    lock(_cpu);
 
     db<Alarm>(TRC) << "~Alarm(this=" << this << ")" << endl;
 
-    _request.remove(this);
+    _request[_cpu].remove(&_link);
+    if(_precise_link.rank())
+        _precise[_cpu].remove(&_precise_link);
 
-    unlock();
+    unlock(_cpu);
 }
 
 void Alarm::period(const Microsecond & p)
 {
-    lock();
+    lock(_cpu);
 
     db<Alarm>(TRC) << "Alarm::period(this=" << this << ",p=" << p << ")" << endl;
 
-    _request.remove(this);
     _time = p;
     _ticks = ticks(p);
-    _request.insert(&_link);
+    if(_interval) {
+        if(_precise_link.rank())
+            _precise[_cpu].remove(&_precise_link);
+        _interval = cycles(Nanosecond(p * 1000ULL));
+        _precise_link.rank(TSC::time_stamp() + _interval);
+        _precise[_cpu].insert(&_precise_link);
+        if((_cpu == Machine::cpu_id()) && (_precise[_cpu].head() == &_precise_link))
+            Timer::precise(_precise_link.rank());
+    } else {
+        _request[_cpu].remove(&_link);
+        _link.rank(_ticks);
+        _request[_cpu].insert(&_link);
+    }
+
+    unlock(_cpu);
 
-    unlock();
+    Timer::wakeup(_cpu);
 }
 
 
@@ -68,13 +113,54 @@ void Alarm::delay(const Microsecond & time)
 }
 
 
+void Alarm::delay(const Nanosecond & time)
+{
+    db<Alarm>(TRC) << "Alarm::delay(time=" << time << "ns)" << endl;
+
+    Semaphore semaphore(0);
+    Semaphore_Handler handler(&semaphore);
+    Alarm alarm(time, &handler, 1);
+    semaphore.p();
+}
+
+
+Alarm::Tick Alarm::next()
+{
+    unsigned int cpu = Machine::cpu_id();
+
+    lock(cpu);
+
+    unsigned int next = _request[cpu].next();
+    if(Timer::high_resolution && !_precise[cpu].empty()) {
+        // Wake up at the tick the request falls in, which then arms the timer for it
+        Time_Stamp now = TSC::time_stamp();
+        Time_Stamp deadline = _precise[cpu].head()->rank();
+        Time_Stamp precise = (deadline > now) ? (deadline - now) / (TSC::frequency() / frequency()) : 0;
+        if(precise < next)
+            next = precise;
+    }
+    Tick ticks = (next > 0x7fffffff) ? 0x7fffffff : (next > 1) ? next : 1;
+
+    unlock(cpu);
+
+    return ticks;
+}
+
+
+// Called by the timer of every CPU, for the requests in that CPU's queue
+// All requests due at this tick are moved at once to the wheel's expired list, but their handlers are
+// dispatched one at a time with the lock released, so an Alarm destroyed in between (e.g. by the idle
+// thread returning to shut the machine down) is simply removed from that list
 void Alarm::handler(const IC::Interrupt_Id & i)
 {
-    lock();
+    unsigned int cpu = Machine::cpu_id();
+
+    lock(cpu);
 
-    _elapsed++;
+    if(cpu == 0)
+        _elapsed++;
 
-    if(Traits<Alarm>::visible) {
+    if(Traits<Alarm>::visible && (cpu == 0)) {
         Display display;
         int lin, col;
         display.position(&lin, &col);
@@ -83,29 +169,75 @@ void Alarm::handler(const IC::Interrupt_Id & i)
         display.position(lin, col);
     }
 
-    Alarm * alarm = 0;
-
-    if(!_request.empty()) {
-        // Replacing the following "if" by a "while" loop is tempting, but recovering the lock and dispatching the handler is
-        // troublesome if the Alarm gets destroyed in between, like is the case for the idle thread returning to shutdown the machine
-        if(_request.head()->promote() <= 0) { // rank can be negative whenever multiple handlers get created for the same time tick
-            Queue::Element * e = _request.remove();
-            alarm = e->object();
-            if(alarm->_times != INFINITE)
-                alarm->_times--;
-            if(alarm->_times) {
-                e->rank(alarm->_ticks);
-                _request.insert(e);
-            }
+    _request[cpu].tick();
+
+    while(true) {
+        Queue::Element * e = _request[cpu].remove_expired();
+        if(!e)
+            break;
+
+        Alarm * alarm = e->object();
+        if(alarm->_times != INFINITE)
+            alarm->_times--;
+        if(alarm->_times) {
+            e->rank(alarm->_ticks);
+            _request[cpu].insert(e);
         }
+
+        unlock(cpu);
+
+        db<Alarm>(TRC) << "Alarm::handler(this=" << alarm << ",e=" << _elapsed << ",h=" << reinterpret_cast<void*>(alarm->_handler) << ")" << endl;
+        (*alarm->_handler)();
+
+        lock(cpu);
     }
 
-    unlock();
+    dispatch(cpu);
+
+    unlock(cpu);
+}
+
 
-    if(alarm) {
-        db<Alarm>(TRC) << "Alarm::handler(this=" << alarm << ",e=" << _elapsed << ",h=" << reinterpret_cast<void*>(alarm->handler) << ")" << endl;
+// Requests are handled one at a time with the lock released, as in handler(), and the timer is then
+// armed for the earliest one left (those beyond the next tick are re-armed by the tick handler)
+void Alarm::dispatch(unsigned int cpu)
+{
+    if(!Timer::high_resolution)
+        return;
+
+    Time_Stamp slack = TSC::frequency() / 1000000; // a microsecond early is in time
+    while(!_precise[cpu].empty() && (_precise[cpu].head()->rank() <= TSC::time_stamp() + slack)) {
+        Precise_Queue::Element * e = _precise[cpu].remove();
+
+        Alarm * alarm = e->object();
+        if(alarm->_times != INFINITE)
+            alarm->_times--;
+        if(alarm->_times) {
+            e->rank(e->rank() + alarm->_interval);
+            _precise[cpu].insert(e);
+        } else
+            e->rank(0);
+
+        unlock(cpu);
+
+        db<Alarm>(TRC) << "Alarm::dispatch(this=" << alarm << ",h=" << reinterpret_cast<void*>(alarm->_handler) << ")" << endl;
         (*alarm->_handler)();
+
+        lock(cpu);
     }
+
+    if(!_precise[cpu].empty())
+        Timer::precise(_precise[cpu].head()->rank());
+}
+
+
+void Alarm::precise_handler(const IC::Interrupt_Id & i)
+{
+    unsigned int cpu = Machine::cpu_id();
+
+    lock(cpu);
+    dispatch(cpu);
+    unlock(cpu);
 }
 
 __END_SYS
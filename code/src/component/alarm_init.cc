@@ -10,6 +10,9 @@ void Alarm::init()
     db<Init, Alarm>(TRC) << "Alarm::init()" << endl;
 
     _timer = new (SYSTEM) Alarm_Timer(handler);
+
+    if(Timer::high_resolution)
+        _precise_timer = new (SYSTEM) Precise_Timer(precise_handler);
 }
 
 __END_SYS
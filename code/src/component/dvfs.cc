@@ -0,0 +1,225 @@
+// EPOS DVFS Governor Component Implementation
+
+#include <dvfs.h>
+#include <thread.h>
+
+__BEGIN_SYS
+
+// Class attributes
+DVFS_Timer * DVFS::_timer;
+DVFS::Governor DVFS::_governor[DVFS::CPUS];
+volatile unsigned int DVFS::_cpu_temperature[DVFS::CPUS];
+volatile DVFS::Hertz DVFS::_cpu_clock[DVFS::CPUS];
+volatile DVFS::Hertz DVFS::_requested_clock[DVFS::CPUS];
+volatile DVFS::Hertz DVFS::_effective_clock[DVFS::CPUS];
+DVFS::Hertz DVFS::_decision[DVFS::CPUS];
+DVFS::Time_Stamp DVFS::_last_sample[DVFS::CPUS];
+DVFS::Time_Stamp DVFS::_last_idle[DVFS::CPUS];
+Percent DVFS::_cpu_load[DVFS::CPUS];
+PMU::Count DVFS::_last_instructions[DVFS::CPUS];
+PMU::Count DVFS::_last_cycles[DVFS::CPUS];
+PMU::Count DVFS::_last_llc_misses[DVFS::CPUS];
+CPU::Reg64 DVFS::_last_aperf[DVFS::CPUS];
+CPU::Reg64 DVFS::_last_mperf[DVFS::CPUS];
+
+
+// Class methods
+void DVFS::clock(unsigned int cpu, const Hertz & clock)
+{
+    db<DVFS>(TRC) << "DVFS::clock(cpu=" << cpu << ",clock=" << clock << ")" << endl;
+
+    assert(cpu < Machine::n_cpus());
+
+    // Requests are not queued: a CPU that has not yet served the previous one simply gets the newest
+    _requested_clock[cpu] = clock;
+
+    if(cpu == Machine::cpu_id()) {
+        bool was_locked = CPU::int_disabled();
+        CPU::int_disable();
+        apply(cpu);
+        if(!was_locked)
+            CPU::int_enable();
+    } else
+        IC::ipi_send(cpu, IC::INT_FREQUENCY);
+}
+
+
+Percent DVFS::load(unsigned int cpu)
+{
+    Time_Stamp now = TSC::time_stamp();
+    Time_Stamp idle = Thread::_idle_time[cpu];
+
+    Time_Stamp elapsed = now - _last_sample[cpu];
+    Time_Stamp idled = idle - _last_idle[cpu];
+
+    _last_sample[cpu] = now;
+    _last_idle[cpu] = idle;
+
+    if(!elapsed)
+        return 0;
+
+    // Interrupt handlers running on the idle thread (including this one) are accounted as idle time, and an idle
+    // interval ending between the two readings might have started before the previous sample
+    if(idled > elapsed)
+        idled = elapsed;
+
+    return 100 - idled * 100 / elapsed;
+}
+
+
+// IA32_MPERF only counts while the core is not halted, so a CPU idle for the whole period keeps its last measure
+void DVFS::measure(unsigned int cpu)
+{
+    if(!CPU::effective()) {
+        _effective_clock[cpu] = _cpu_clock[cpu];
+        return;
+    }
+
+    CPU::Reg64 aperf = CPU::aperf();
+    CPU::Reg64 mperf = CPU::mperf();
+
+    CPU::Reg64 delivered = aperf - _last_aperf[cpu];
+    CPU::Reg64 reference = mperf - _last_mperf[cpu];
+
+    _last_aperf[cpu] = aperf;
+    _last_mperf[cpu] = mperf;
+
+    if(reference)
+        _effective_clock[cpu] = static_cast<CPU::Reg64>(CPU::clock() / 1000) * delivered / reference * 1000;
+}
+
+
+void DVFS::scale(const Hertz & clock)
+{
+    if(!CPU::max_ratio()) {
+        CPU::clock(clock);
+        return;
+    }
+
+    CPU::Ratio ratio = CPU::clock2ratio(clock);
+    Hertz pstate = CPU::ratio2clock(ratio);
+
+    CPU::frequency(ratio);
+
+    // Duty-cycle the lowest P-state to reach clocks it cannot provide by itself
+    if(clock < pstate)
+        CPU::clock(static_cast<unsigned long long>(clock) * CPU::clock() / pstate);
+    else
+        CPU::clock(CPU::clock());
+}
+
+
+// Must run on "cpu" with interrupts disabled
+void DVFS::apply(unsigned int cpu)
+{
+    Hertz clock = _requested_clock[cpu];
+
+    // Only touch IA32_PERF_CTL and IA32_CLOCK_MODULATION when the clock actually changes
+    if(clock != _cpu_clock[cpu]) {
+        _cpu_clock[cpu] = clock;
+        scale(clock);
+
+        Trace::record(Trace::CLOCK);
+    }
+}
+
+
+void DVFS::governor(const IC::Interrupt_Id & i)
+{
+    unsigned int cpu = Machine::cpu_id();
+
+    _cpu_temperature[cpu] = Thermal::temperature();
+
+    Trace::record(Trace::SAMPLE, Thread::self());
+
+    _cpu_load[cpu] = load(cpu);
+    measure(cpu);
+
+    Sample sample;
+    account(cpu, &sample, Thread::self());
+    if(decide(cpu, sample))
+        apply(cpu);
+
+    if(cpu == 0)
+        Balancer::balance(_cpu_temperature);
+}
+
+
+// Called by Thread::dispatch() for per-thread governors, so the thread leaving the CPU
+// is classified over the quantum it just ran and the clock is set for the one arriving.
+// The scheduler lock is still held, so a new clock is only posted here and applied by a
+// self INT_FREQUENCY IPI, taken once the switch is done and interrupts are enabled again.
+void DVFS::dispatch(Thread * prev, Thread * next)
+{
+    unsigned int cpu = Machine::cpu_id();
+
+    Sample sample;
+    account(cpu, &sample, prev);
+
+    // The clock for IDLE doesn't matter, so don't waste MSR writes on it
+    if(next->_link.rank() == Thread::IDLE)
+        return;
+
+    sample.phase = next->_phase;
+    if(decide(cpu, sample)) {
+        if(Traits<System>::multicore)
+            IC::ipi_send(cpu, IC::INT_FREQUENCY);
+        else
+            apply(cpu);
+    }
+}
+
+
+// Fills "sample" with the counts since the previous one, which were all due to "thread"
+void DVFS::account(unsigned int cpu, Sample * sample, Thread * thread)
+{
+    PMU::Count instructions = PMU::read(INSTRUCTIONS);
+    PMU::Count cycles = PMU::read(CYCLES);
+    PMU::Count llc_misses = PMU::read(LLC_MISSES);
+
+    sample->temperature = _cpu_temperature[cpu];
+    sample->load = _cpu_load[cpu];
+    sample->clock = _cpu_clock[cpu];
+    sample->instructions = instructions - _last_instructions[cpu];
+    sample->cycles = cycles - _last_cycles[cpu];
+    sample->llc_misses = llc_misses - _last_llc_misses[cpu];
+
+    _last_instructions[cpu] = instructions;
+    _last_cycles[cpu] = cycles;
+    _last_llc_misses[cpu] = llc_misses;
+
+    if(per_thread && (thread->_link.rank() != Thread::IDLE))
+        thread->_phase = _governor[cpu].classify(*sample, thread->_phase);
+
+    sample->phase = thread->_phase;
+}
+
+
+// Posts the clock the governor decides for "cpu", returning whether it has to be applied
+bool DVFS::decide(unsigned int cpu, const Sample & sample)
+{
+    Hertz clock = _governor[cpu].decide(sample);
+
+    // Clocks set through DVFS::clock(cpu, clock) hold until the local governor changes its mind
+    if(clock == _decision[cpu])
+        return false;
+
+    db<DVFS>(TRC) << "DVFS::decide(cpu=" << cpu << ",temp=" << sample.temperature << ",load=" << sample.load << ",phase=" << sample.phase << ") => " << clock << endl;
+
+    _decision[cpu] = clock;
+    _requested_clock[cpu] = clock;
+
+    return true;
+}
+
+
+void DVFS::frequency(const IC::Interrupt_Id & i)
+{
+    unsigned int cpu = Machine::cpu_id();
+
+    db<DVFS>(TRC) << "DVFS::frequency(cpu=" << cpu << ",clock=" << _requested_clock[cpu] << ")" << endl;
+
+    apply(cpu);
+}
+
+__END_SYS
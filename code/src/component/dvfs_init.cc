@@ -0,0 +1,76 @@
+// EPOS DVFS Governor Component Initialization
+
+#include <system.h>
+#include <dvfs.h>
+#include <thread.h>
+
+__BEGIN_SYS
+
+// Programs the statistics channels of the calling CPU's PMU. Also called on its
+// own when DVFS is disabled but Thread keeps per-thread counts (Thread::counters())
+void DVFS::monitor()
+{
+    db<Init, DVFS>(TRC) << "DVFS::monitor()" << endl;
+
+    // Capturing INSTRUCTION, LLC_MISS, CLOCK (core cycles)
+    APIC::disable_perf_int();
+
+    PMU::stop(INSTRUCTIONS);
+    PMU::stop(LLC_MISSES);
+    PMU::stop(CYCLES);
+
+    PMU::reset(INSTRUCTIONS);
+    PMU::reset(LLC_MISSES);
+    PMU::reset(CYCLES);
+
+    PMU::write(INSTRUCTIONS, 0);
+    PMU::write(LLC_MISSES, 0);
+    PMU::write(CYCLES, 0);
+
+    PMU::config(INSTRUCTIONS, PMU::INSTRUCTION);
+    PMU::config(LLC_MISSES, PMU::LLC_MISS);
+    PMU::config(CYCLES, PMU::CLOCK);
+
+    PMU::start(INSTRUCTIONS);
+    PMU::start(LLC_MISSES);
+    PMU::start(CYCLES);
+
+    APIC::enable_perf_int();
+}
+
+
+// Called by every CPU, since both the PMU and the thermal sensors are local to each core
+void DVFS::init()
+{
+    db<Init, DVFS>(TRC) << "DVFS::init()" << endl;
+
+    unsigned int cpu = Machine::cpu_id();
+
+    monitor();
+
+    _cpu_temperature[cpu] = Thermal::temperature();
+    _cpu_clock[cpu] = CPU::frequency();
+    _requested_clock[cpu] = _cpu_clock[cpu];
+    _effective_clock[cpu] = _cpu_clock[cpu];
+    _last_aperf[cpu] = CPU::aperf();
+    _last_mperf[cpu] = CPU::mperf();
+    _decision[cpu] = _cpu_clock[cpu];
+    _last_sample[cpu] = TSC::time_stamp();
+    _last_idle[cpu] = 0;
+    _cpu_load[cpu] = 0;
+    _last_instructions[cpu] = PMU::read(INSTRUCTIONS);
+    _last_cycles[cpu] = PMU::read(CYCLES);
+    _last_llc_misses[cpu] = PMU::read(LLC_MISSES);
+
+    // Install an interrupt handler to receive frequency changes requested by other CPUs
+    if(Traits<System>::multicore) {
+        if(cpu == 0)
+            IC::int_vector(IC::INT_FREQUENCY, frequency);
+        IC::enable(IC::INT_FREQUENCY);
+    }
+
+    if(cpu == 0)
+        _timer = new (SYSTEM) DVFS_Timer(PERIOD, governor);
+}
+
+__END_SYS
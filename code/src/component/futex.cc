@@ -0,0 +1,75 @@
+// EPOS Futex Component Implementation
+
+#include <futex.h>
+
+__BEGIN_SYS
+
+// Class attributes
+Futex::Table Futex::_waiters;
+Simple_Spin Futex::_locks[BUCKETS];
+
+
+// Class methods
+bool Futex::wait(volatile int * address, int value)
+{
+    db<Synchronizer>(TRC) << "Futex::wait(a=" << const_cast<int *>(address) << ",v=" << value << ")" << endl;
+
+    Key k = key(address);
+    Waiter waiter(k);
+
+    lock(k);
+    if(*address != value) {
+        unlock(k);
+        return false;
+    }
+
+    _waiters.insert(&waiter.link);
+    Thread::self()->_futex = k;
+    Thread::sleep(&waiter.queue, &_locks[k % BUCKETS]); // implicit unlock(), removed from _waiters by wake()
+    Thread::self()->_futex = 0;
+
+    return true;
+}
+
+
+unsigned int Futex::wake(volatile int * address, unsigned int n)
+{
+    db<Synchronizer>(TRC) << "Futex::wake(a=" << const_cast<int *>(address) << ",n=" << n << ")" << endl;
+
+    Key k = key(address);
+
+    // Waiters with the same key are kept in the order they came
+    unsigned int woken;
+    for(woken = 0; woken < n; woken++) {
+        lock(k);
+        Element * e = _waiters.remove_key(k);
+        if(!e) {
+            unlock(k);
+            break;
+        }
+        Thread::wakeup(&e->object()->queue, &_locks[k % BUCKETS]); // implicit unlock()
+    }
+
+    return woken;
+}
+
+
+// Called by ~Thread for a thread that might still be waiting. The waiter lives on the thread's stack, so unless
+// wake() has already taken it, it is removed from _waiters before the stack goes away (~Thread then takes the
+// thread out of the waiter's queue).
+void Futex::abandon(Thread * thread)
+{
+    db<Synchronizer>(TRC) << "Futex::abandon(t=" << thread << ")" << endl;
+
+    Key k = thread->_futex;
+
+    lock(k);
+    for(Element * e = _waiters[k]->head(); e; e = e->next())
+        if(&e->object()->queue == thread->_waiting) {
+            _waiters.remove(e);
+            break;
+        }
+    unlock(k);
+}
+
+__END_SYS
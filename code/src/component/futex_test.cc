@@ -0,0 +1,106 @@
+// EPOS Futex Component Test Program
+
+// Producers and consumers on all CPUs share a bounded buffer through Futex_Semaphore and Futex_Mutex, and then
+// wait on a Futex_Condition until main() broadcasts it. Contended operations are the only ones that call
+// Futex::wait() and Futex::wake(), which are counted here.
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+#include <futex.h>
+#include <alarm.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Build>::CPUS;
+const int iterations = 10000;
+const int BUF_SIZE = 16;
+
+// Counts the calls that enter the kernel's wait queues
+struct Counting_Futex
+{
+    static bool wait(volatile int * address, int value) { CPU::finc(waits); return Futex::wait(address, value); }
+    static unsigned int wake(volatile int * address, unsigned int n = 1) { CPU::finc(wakes); return Futex::wake(address, n); }
+
+    static volatile int waits;
+    static volatile int wakes;
+};
+volatile int Counting_Futex::waits;
+volatile int Counting_Futex::wakes;
+
+OStream cout;
+
+int buffer[BUF_SIZE];
+int in, out;
+volatile int sum;
+volatile int finished;
+
+Futex_Semaphore<Counting_Futex> empty(BUF_SIZE);
+Futex_Semaphore<Counting_Futex> full(0);
+Futex_Mutex<Counting_Futex> mutex;
+Futex_Condition<Counting_Futex> done;
+
+int producer()
+{
+    for(int i = 1; i <= iterations; i++) {
+        empty.p();
+        mutex.lock();
+        buffer[in] = i;
+        in = (in + 1) % BUF_SIZE;
+        mutex.unlock();
+        full.v();
+    }
+
+    return 0;
+}
+
+int consumer()
+{
+    for(int i = 0; i < iterations; i++) {
+        full.p();
+        mutex.lock();
+        sum = sum + buffer[out];
+        out = (out + 1) % BUF_SIZE;
+        mutex.unlock();
+        empty.v();
+    }
+
+    CPU::finc(finished);
+    done.wait();
+
+    return 0;
+}
+
+int main()
+{
+    cout << "Futex Component Test" << endl;
+
+    unsigned int n = Machine::n_cpus() / 2;
+    if(n == 0)
+        n = 1;
+
+    Thread * threads[CPUS * 2];
+    for(unsigned int i = 0; i < n; i++) {
+        threads[2 * i] = new Thread(&producer);
+        threads[2 * i + 1] = new Thread(&consumer);
+    }
+
+    while(finished < static_cast<int>(n))
+        Alarm::delay(10000);
+    Alarm::delay(10000); // let the consumers get to wait()
+    done.broadcast();
+
+    for(unsigned int i = 0; i < 2 * n; i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    int expected = n * iterations * (iterations + 1) / 2;
+    cout << n << " producers and " << n << " consumers: sum=" << sum << " (expected " << expected << ")" << endl;
+    cout << "Operations: " << 4 * 2 * n * iterations << ", waits=" << Counting_Futex::waits << ", wakes=" << Counting_Futex::wakes << endl;
+    cout << ((sum == expected) ? "Passed!" : "FAILED!") << endl;
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+// EPOS Heap Microbenchmark
+
+// One thread per CPU keeps a working set of SLOTS blocks and, for a fixed time, frees a random one and allocates
+// another of random size in its place. Small blocks (up to 256 bytes) come from the per-CPU caches in front of the
+// heap in multicore builds, while large ones still search the heap under its lock. Every block is filled with its
+// owner's tag and checked before being freed, which a block handed out twice would break.
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+#include <tsc.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Build>::CPUS;
+const unsigned int DURATION = 200; // ms per run
+const unsigned int SLOTS = 64;
+
+struct Statistics
+{
+    unsigned long long operations;
+    unsigned long long errors;
+};
+
+OStream cout;
+
+Statistics stats[CPUS];
+volatile TSC::Time_Stamp deadline;
+
+int worker(unsigned int cpu, unsigned int min, unsigned int max)
+{
+    Statistics & s = stats[cpu];
+    unsigned char tag = 'A' + cpu;
+    unsigned char * block[SLOTS];
+    unsigned int size[SLOTS];
+
+    for(unsigned int i = 0; i < SLOTS; i++)
+        block[i] = 0;
+
+    for(unsigned int n = cpu; TSC::time_stamp() < deadline; n = n * 1103515245 + 12345) {
+        unsigned int i = (n >> 16) % SLOTS;
+        if(block[i]) {
+            for(unsigned int j = 0; j < size[i]; j++)
+                if(block[i][j] != tag)
+                    s.errors++;
+            delete [] block[i];
+        }
+
+        size[i] = min + (n >> 8) % (max - min + 1);
+        block[i] = new unsigned char[size[i]];
+        for(unsigned int j = 0; j < size[i]; j++)
+            block[i][j] = tag;
+
+        s.operations++;
+    }
+
+    for(unsigned int i = 0; i < SLOTS; i++)
+        delete [] block[i];
+
+    return 0;
+}
+
+void run(const char * name, unsigned int min, unsigned int max)
+{
+    for(unsigned int n = 1; n <= Machine::n_cpus(); n *= 2) {
+        for(unsigned int i = 0; i < n; i++)
+            stats[i].operations = stats[i].errors = 0;
+        deadline = TSC::time_stamp() + DURATION * (TSC::frequency() / 1000);
+
+        Thread * workers[CPUS];
+        for(unsigned int i = 0; i < n; i++)
+            workers[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, i)), &worker, i, min, max);
+        for(unsigned int i = 0; i < n; i++) {
+            workers[i]->join();
+            delete workers[i];
+        }
+
+        unsigned long long operations = 0;
+        unsigned long long errors = 0;
+        for(unsigned int i = 0; i < n; i++) {
+            operations += stats[i].operations;
+            errors += stats[i].errors;
+        }
+
+        cout << name << " (" << min << "-" << max << " bytes) on " << n << " CPUs: alloc/free pairs=" << operations
+             << " (" << operations / DURATION << "/ms), corrupted bytes=" << errors << endl;
+    }
+}
+
+int main()
+{
+    cout << "Heap Microbenchmark (" << Machine::n_cpus() << " CPUs, " << DURATION << " ms per run, " << SLOTS << " blocks per thread)" << endl;
+
+    run("Small", 8, 256);
+    run("Large", 512, 2048);
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
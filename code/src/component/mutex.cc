@@ -1,10 +1,16 @@
 // EPOS Mutex Component Implementation
 
 #include <mutex.h>
+#include <alarm.h>
 
 __BEGIN_SYS
 
-Mutex::Mutex(): _locked(false)
+// Class attributes
+Simple_Spin Inheritance_Mutex::_chain;
+
+
+// Methods
+Mutex::Mutex(): _state(FREE), _owner(0)
 {
     db<Synchronizer>(TRC) << "Mutex() => " << this << endl;
 }
@@ -20,11 +26,41 @@ void Mutex::lock()
 {
     db<Synchronizer>(TRC) << "Mutex::lock(this=" << this << ")" << endl;
 
+    if(cas(_state, FREE, LOCKED) == FREE) {
+        _owner = Thread::self();
+        return;
+    }
+
+    // Spinning only pays off while the owner is running (on another CPU, since we are running)
+    int limit = spin_limit();
+    int n;
+    for(n = 0; n < limit; n++) {
+        Thread * owner = _owner;
+        if(owner && (owner->state() != Thread::RUNNING))
+            break;
+
+        if((_state == FREE) && (cas(_state, FREE, LOCKED) == FREE)) {
+            spun(n);
+            _owner = Thread::self();
+            return;
+        }
+    }
+    if(limit && (n == limit))
+        spun(limit);
+
     begin_atomic();
-    if(tsl(_locked))
-        sleep(); // implicit end_atomic()
-    else
+    int state;
+    do
+        state = _state;
+    while(cas(_state, state, CONTENDED) != state);
+
+    if(state == FREE) {
+        _owner = Thread::self();
         end_atomic();
+    } else {
+        sleep(); // implicit end_atomic()
+        _owner = Thread::self(); // handed over by unlock()
+    }
 }
 
 
@@ -32,12 +68,140 @@ void Mutex::unlock()
 {
     db<Synchronizer>(TRC) << "Mutex::unlock(this=" << this << ")" << endl;
 
+    _owner = 0;
+    if(cas(_state, LOCKED, FREE) == LOCKED)
+        return;
+
     begin_atomic();
     if(_queue.empty()) {
-        _locked = false;
+        _state = FREE;
         end_atomic();
     } else
         wakeup(); // implicit end_atomic()
 }
 
+
+Inheritance_Mutex::Inheritance_Mutex(): _locked(false), _owner(0), _ceiling(NONE), _boost(NONE), _link(this)
+{
+    db<Synchronizer>(TRC) << "Inheritance_Mutex() => " << this << endl;
+}
+
+
+Inheritance_Mutex::Inheritance_Mutex(int ceiling): _locked(false), _owner(0), _ceiling(ceiling), _boost(NONE), _link(this)
+{
+    db<Synchronizer>(TRC) << "Ceiling_Mutex(c=" << ceiling << ") => " << this << endl;
+}
+
+
+Inheritance_Mutex::~Inheritance_Mutex()
+{
+    db<Synchronizer>(TRC) << "~Inheritance_Mutex(this=" << this << ")" << endl;
+}
+
+
+void Inheritance_Mutex::lock()
+{
+    db<Synchronizer>(TRC) << "Inheritance_Mutex::lock(this=" << this << ")" << endl;
+
+    lock_chain();
+
+    Thread * self = Thread::self();
+    if(!_locked) {
+        acquire(self);
+        unlock_chain();
+        return;
+    }
+
+    // We are not yet in _queue, so our priority is handed to the owner explicitly
+    self->_blocker = this;
+    propagate(_owner, self->priority());
+
+    Thread::sleep(&_queue, &_chain); // the mutex is handed over by unlock()
+}
+
+
+void Inheritance_Mutex::unlock()
+{
+    db<Synchronizer>(TRC) << "Inheritance_Mutex::unlock(this=" << this << ")" << endl;
+
+    lock_chain();
+
+    Thread * self = _owner;
+    self->_held.remove(&_link);
+    _locked = false;
+    _owner = 0;
+    _boost = NONE;
+    bool lowered = propagate(self);
+
+    if(!_queue.empty()) {
+        Thread * next = _queue.head()->object();
+        next->_blocker = 0;
+        acquire(next);
+        Thread::wakeup(&_queue, &_chain);
+    } else
+        unlock_chain();
+
+    // Others on this CPU may now be more urgent than us
+    if(lowered && Thread::preemptive) {
+        Thread::lock();
+        Thread::reschedule();
+    }
+}
+
+
+// The priority the owner must run at on this mutex's account
+int Inheritance_Mutex::level()
+{
+    int level = _boost;
+    if(!_queue.empty() && (_queue.head()->rank() < level))
+        level = _queue.head()->rank();
+    return level;
+}
+
+
+void Inheritance_Mutex::acquire(Thread * owner)
+{
+    _locked = true;
+    _owner = owner;
+
+    if(_ceiling != NONE)
+        _boost = Criterion::dynamic ? static_cast<int>(Alarm::_elapsed + _ceiling) : _ceiling;
+
+    if(owner->_held.empty())
+        owner->_natural = owner->priority();
+    owner->_held.insert(&_link);
+
+    propagate(owner);
+}
+
+
+// Recomputes the priority of "t" from its natural one, the mutexes it owns and "inherited", then does the same
+// for the owner of the mutex "t" waits for, if any, and so on. Returns whether "t" itself got less urgent.
+bool Inheritance_Mutex::propagate(Thread * t, int inherited)
+{
+    bool lowered = false;
+
+    for(bool first = true; t; first = false) {
+        int priority = t->_natural;
+        for(Simple_List<Inheritance_Mutex>::Element * e = t->_held.head(); e; e = e->next())
+            if(e->object()->level() < priority)
+                priority = e->object()->level();
+        if(inherited < priority)
+            priority = inherited;
+
+        if(priority == t->priority())
+            break;
+
+        if(first)
+            lowered = priority > t->priority();
+
+        t->inherit(priority);
+
+        inherited = NONE;
+        t = t->_blocker ? t->_blocker->_owner : 0;
+    }
+
+    return lowered;
+}
+
 __END_SYS
@@ -15,6 +15,12 @@ struct Traits
     typedef TLIST<> ASPECTS;
 };
 
+__END_SYS
+
+#include <system/traits_defaults.h>
+
+__BEGIN_SYS
+
 template<> struct Traits<Build>
 {
     enum {LIBRARY, BUILTIN, KERNEL};
@@ -48,7 +54,7 @@ template<> struct Traits<Lists>: public Traits<void>
     static const bool debugged = hysterically_debugged;
 };
 
-template<> struct Traits<Spin>: public Traits<void>
+template<> struct Traits<Spin>: public Default_Traits<Spin>
 {
     static const bool debugged = hysterically_debugged;
 };
@@ -181,6 +187,12 @@ template<> struct Traits<Timer>: public Traits<Machine_Common>
     // 10000 Hz. The choice must respect the scheduler time-slice, i. e.,
     // it must be higher than the scheduler invocation frequency.
     static const int FREQUENCY = 1000; // Hz
+
+    // Tickless idle: halted CPUs program the timer one-shot to their next event instead of ticking (multicore only)
+    static const bool tickless = true;
+
+    // High-resolution alarms: the local timer is split one-shot at Alarm(Nanosecond) deadlines (multicore only)
+    static const bool high_resolution = true;
 };
 
 template<> struct Traits<RTC>: public Traits<Machine_Common>
@@ -305,7 +317,7 @@ template<> struct Traits<Task>: public Traits<void>
     static const bool enabled = Traits<System>::multitask;
 };
 
-template<> struct Traits<Thread>: public Traits<void>
+template<> struct Traits<Thread>: public Default_Traits<Thread>
 {
     static const bool smp = Traits<System>::multicore;
 
@@ -315,12 +327,20 @@ template<> struct Traits<Thread>: public Traits<void>
     static const bool trace_idle = hysterically_debugged;
 };
 
-template<> struct Traits<Scheduler<Thread> >: public Traits<void>
+template<> struct Traits<DVFS>: public Default_Traits<DVFS>
+{
+};
+
+template<> struct Traits<Trace>: public Default_Traits<Trace>
+{
+};
+
+template<> struct Traits<Scheduler<Thread> >: public Default_Traits<Scheduler<Thread> >
 {
     static const bool debugged = Traits<Thread>::trace_idle || hysterically_debugged;
 };
 
-template<> struct Traits<Periodic_Thread>: public Traits<void>
+template<> struct Traits<Periodic_Thread>: public Default_Traits<Periodic_Thread>
 {
     static const bool simulate_capacity = false;
 };
@@ -340,7 +360,7 @@ template<> struct Traits<Alarm>: public Traits<void>
     static const bool visible = hysterically_debugged;
 };
 
-template<> struct Traits<Synchronizer>: public Traits<void>
+template<> struct Traits<Synchronizer>: public Default_Traits<Synchronizer>
 {
     static const bool enabled = Traits<System>::multithread;
 };
@@ -0,0 +1,115 @@
+// EPOS Priority Inheritance Mutex Component Test Program
+
+#include <utility/ostream.h>
+#include <thread.h>
+#include <mutex.h>
+#include <alarm.h>
+#include <chronometer.h>
+
+using namespace EPOS;
+
+const unsigned int wcet = 50; // ms
+
+const int LOW = 30;
+const int MEDIUM = 20;
+const int HIGH = 10;
+
+OStream cout;
+Chronometer chrono;
+
+Inheritance_Mutex inheritance;
+Ceiling_Mutex ceiling((Thread::Criterion(HIGH)));
+
+Thread * low;
+Thread * medium;
+Thread * high;
+
+char order[3];
+int done;
+
+inline void exec(unsigned int time) // in miliseconds
+{
+    // Delay was not used here to prevent scheduling interference due to blocking
+    Chronometer::Microsecond end = chrono.read() / 1000 + time;
+    while(chrono.read() / 1000 < end);
+}
+
+template<typename M>
+int holder(M * mutex)
+{
+    mutex->lock();
+    exec(wcet);
+    cout << "L holds the mutex with p(L)=" << low->priority() << endl;
+    order[done++] = 'L'; // H preempts L as soon as it is unlocked
+    mutex->unlock();
+
+    return 'L';
+}
+
+int hog()
+{
+    exec(wcet);
+    order[done++] = 'M';
+
+    return 'M';
+}
+
+template<typename M>
+int waiter(M * mutex)
+{
+    mutex->lock();
+    order[done++] = 'H';
+    mutex->unlock();
+
+    return 'H';
+}
+
+template<typename M>
+bool round(M * mutex)
+{
+    done = 0;
+
+    low = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(LOW)), &holder<M>, mutex);
+    Delay to_lock(wcet * 1000 / 5);
+
+    high = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(HIGH)), &waiter<M>, mutex);
+    medium = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(MEDIUM)), &hog);
+
+    low->join();
+    medium->join();
+    high->join();
+
+    cout << "Completion order: " << order[0] << order[1] << order[2] << endl;
+
+    delete low;
+    delete medium;
+    delete high;
+
+    return (order[0] == 'L') && (order[1] == 'H') && (order[2] == 'M');
+}
+
+int main()
+{
+    cout << "Priority Inheritance Mutex Component Test" << endl;
+
+    cout << "\nThis test consists in creating three threads as follows:" << endl;
+    cout << "- L (p=" << LOW << ") locks a mutex and computes for " << wcet << "ms before unlocking it;" << endl;
+    cout << "- H (p=" << HIGH << ") is released while L holds the mutex and blocks on it;" << endl;
+    cout << "- M (p=" << MEDIUM << ") is released together with H and computes for " << wcet << "ms." << endl;
+    cout << "Without inheritance, M would preempt L and delay H. It must complete last." << endl;
+
+    chrono.start();
+
+    cout << "\nInheritance_Mutex:" << endl;
+    bool inherited = round(&inheritance);
+
+    cout << "\nCeiling_Mutex:" << endl;
+    bool ceiled = round(&ceiling);
+
+    chrono.stop();
+
+    cout << "\nInheritance " << (inherited ? "passed" : "FAILED") << ", ceiling " << (ceiled ? "passed" : "FAILED") << "!" << endl;
+    cout << "I'm also done, bye!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+// EPOS Reader-Writer Lock Component Implementation
+
+#include <rw_lock.h>
+
+__BEGIN_SYS
+
+// Methods
+RW_Lock::RW_Lock(): _state(0)
+{
+    db<Synchronizer>(TRC) << "RW_Lock() => " << this << endl;
+}
+
+
+RW_Lock::~RW_Lock()
+{
+    db<Synchronizer>(TRC) << "~RW_Lock(this=" << this << ")" << endl;
+
+    begin_atomic();
+    wakeup_all(&_readers);
+}
+
+
+void RW_Lock::read_lock()
+{
+    db<Synchronizer>(TRC) << "RW_Lock::read_lock(this=" << this << ",state=" << hex << _state << dec << ")" << endl;
+
+    int state = _state;
+    if(!(state & (WRITER | WRITING)) && (cas(_state, state, state + 1) == state))
+        return;
+
+    begin_atomic();
+    for(;;) {
+        state = _state;
+        if(!(state & (WRITER | WRITING))) {
+            if(cas(_state, state, state + 1) == state) {
+                end_atomic();
+                return;
+            }
+        } else if(cas(_state, state, state | READING) == state) {
+            sleep(&_readers); // implicit end_atomic(), counted in by write_unlock()
+            return;
+        }
+    }
+}
+
+
+void RW_Lock::read_unlock()
+{
+    db<Synchronizer>(TRC) << "RW_Lock::read_unlock(this=" << this << ",state=" << hex << _state << dec << ")" << endl;
+
+    // Only the last reader out has to hand the lock over to a waiting writer
+    int state;
+    do {
+        state = _state;
+        if(((state & READERS) == 1) && (state & WRITING))
+            break;
+        if(cas(_state, state, state - 1) == state)
+            return;
+    } while(true);
+
+    // Neither readers nor writers get in while WRITING is set and we are inside, so _state is ours
+    begin_atomic();
+    state = _state;
+    _state = (state & READING) | WRITER | ((_queue.size() > 1) ? WRITING : 0);
+    wakeup(); // implicit end_atomic()
+}
+
+
+void RW_Lock::write_lock()
+{
+    db<Synchronizer>(TRC) << "RW_Lock::write_lock(this=" << this << ",state=" << hex << _state << dec << ")" << endl;
+
+    if(cas(_state, 0, WRITER) == 0)
+        return;
+
+    begin_atomic();
+    for(;;) {
+        int state = _state;
+        if(!(state & (WRITER | READERS))) {
+            if(cas(_state, state, state | WRITER) == state) {
+                end_atomic();
+                return;
+            }
+        } else if(cas(_state, state, state | WRITING) == state) {
+            sleep(); // implicit end_atomic(), handed over by read_unlock() or write_unlock()
+            return;
+        }
+    }
+}
+
+
+void RW_Lock::write_unlock()
+{
+    db<Synchronizer>(TRC) << "RW_Lock::write_unlock(this=" << this << ",state=" << hex << _state << dec << ")" << endl;
+
+    if(cas(_state, WRITER, 0) == WRITER)
+        return;
+
+    // Nothing else changes _state while WRITER is set, except for threads holding the lock we are about to take
+    begin_atomic();
+    if(!_queue.empty()) {
+        _state = (_state & READING) | WRITER | ((_queue.size() > 1) ? WRITING : 0);
+        wakeup(); // implicit end_atomic()
+    } else {
+        _state = _readers.size();
+        wakeup_all(&_readers); // implicit end_atomic()
+    }
+}
+
+__END_SYS
@@ -0,0 +1,101 @@
+// EPOS Reader-Writer Lock Component Microbenchmark
+
+// One thread per CPU looks up a shared table for a fixed time and, once every WRITES lookups, updates all of
+// its entries. The table is guarded by a Mutex and then by an RW_Lock. Every lookup checks that all entries
+// are equal, which a reader overlapping a writer would not see.
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+#include <mutex.h>
+#include <rw_lock.h>
+#include <tsc.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Build>::CPUS;
+const unsigned int DURATION = 200; // ms per run
+const unsigned int ENTRIES = 64;
+const unsigned int WRITES = 20;    // one update every WRITES operations
+
+OStream cout;
+
+volatile unsigned int table[ENTRIES];
+unsigned long long operations[CPUS];
+unsigned long long errors[CPUS];
+volatile TSC::Time_Stamp deadline;
+
+Mutex mutex;
+RW_Lock rw_lock;
+
+void read_lock(Mutex * m) { m->lock(); }
+void read_unlock(Mutex * m) { m->unlock(); }
+void write_lock(Mutex * m) { m->lock(); }
+void write_unlock(Mutex * m) { m->unlock(); }
+
+void read_lock(RW_Lock * l) { l->read_lock(); }
+void read_unlock(RW_Lock * l) { l->read_unlock(); }
+void write_lock(RW_Lock * l) { l->write_lock(); }
+void write_unlock(RW_Lock * l) { l->write_unlock(); }
+
+template<typename Lock>
+int worker(Lock * lock, unsigned int cpu)
+{
+    for(unsigned int n = 0; TSC::time_stamp() < deadline; n++) {
+        if((n % WRITES) == (cpu % WRITES)) {
+            write_lock(lock);
+            for(unsigned int i = 0; i < ENTRIES; i++)
+                table[i] = table[i] + 1;
+            write_unlock(lock);
+        } else {
+            read_lock(lock);
+            unsigned int first = table[0];
+            for(unsigned int i = 1; i < ENTRIES; i++)
+                if(table[i] != first)
+                    errors[cpu]++;
+            read_unlock(lock);
+        }
+        operations[cpu]++;
+    }
+
+    return 0;
+}
+
+template<typename Lock>
+void run(const char * name, Lock * lock)
+{
+    for(unsigned int n = 1; n <= Machine::n_cpus(); n *= 2) {
+        for(unsigned int i = 0; i < n; i++)
+            operations[i] = errors[i] = 0;
+        deadline = TSC::time_stamp() + DURATION * (TSC::frequency() / 1000);
+
+        Thread * workers[CPUS];
+        for(unsigned int i = 0; i < n; i++)
+            workers[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, i)), &worker<Lock>, lock, i);
+        for(unsigned int i = 0; i < n; i++) {
+            workers[i]->join();
+            delete workers[i];
+        }
+
+        unsigned long long total = 0;
+        unsigned long long wrong = 0;
+        for(unsigned int i = 0; i < n; i++) {
+            total += operations[i];
+            wrong += errors[i];
+        }
+
+        cout << name << " on " << n << " CPUs: operations=" << total << " (" << total / DURATION << "/ms), inconsistent reads=" << wrong << endl;
+    }
+}
+
+int main()
+{
+    cout << "Reader-Writer Lock Microbenchmark (" << Machine::n_cpus() << " CPUs, " << DURATION << " ms per run, 1 write every " << WRITES << " operations)" << endl;
+
+    run("Mutex", &mutex);
+    run("RW_Lock", &rw_lock);
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
@@ -1,10 +1,154 @@
 // EPOS CPU Affinity Scheduler Component Implementation
 
 #include <scheduler.h>
+#include <dvfs.h>
 
 __BEGIN_SYS
 
 // Class attributes
 volatile unsigned int Scheduling_Criteria::Variable_Queue::_next_queue;
 
+volatile unsigned int Scheduling_Criteria::Partitioner::_load[Scheduling_Criteria::Partitioner::QUEUES];
+unsigned int Scheduling_Criteria::Partitioner::_next_queue;
+Simple_Spin Scheduling_Criteria::Partitioner::_lock;
+
+
+// Class methods
+namespace Scheduling_Criteria {
+
+// Capacities are given at the nominal clock, so the bound shrinks with the lower of the clock requested for the
+// queue's CPU and the one it actually delivered (e.g. when thermally throttled)
+unsigned int Partitioner::capacity(unsigned int queue, unsigned int bound)
+{
+    if(!DVFS::enabled || !DVFS::clock(queue))
+        return bound;
+
+    DVFS::Hertz clock = DVFS::clock(queue);
+    if(DVFS::effective_clock(queue) && (DVFS::effective_clock(queue) < clock))
+        clock = DVFS::effective_clock(queue);
+
+    return static_cast<unsigned long long>(bound) * clock / CPU::clock();
+}
+
+// Best and worst fit start looking at a queue that rotates among calls, so ties (e.g. the zero utilization of tasks
+// with unknown capacity) spread tasks round-robin instead of piling them on the first queue
+int Partitioner::fit(unsigned int utilization, unsigned int bound, int exclude)
+{
+    int chosen = -1;
+    unsigned int chosen_slack = 0;
+
+    unsigned int first = 0;
+    if(HEURISTIC != FIRST_FIT)
+        first = _next_queue++ % Machine::n_cpus();
+
+    for(unsigned int i = 0; i < Machine::n_cpus(); i++) {
+        unsigned int q = (first + i) % Machine::n_cpus();
+        if(static_cast<int>(q) == exclude)
+            continue;
+
+        unsigned int available = capacity(q, bound);
+        if(_load[q] + utilization > available)
+            continue;
+
+        unsigned int slack = available - _load[q] - utilization;
+        switch(HEURISTIC) {
+        case FIRST_FIT:
+            return q;
+        case BEST_FIT:
+            if((chosen < 0) || (slack < chosen_slack)) {
+                chosen = q;
+                chosen_slack = slack;
+            }
+            break;
+        case WORST_FIT:
+            if((chosen < 0) || (slack > chosen_slack)) {
+                chosen = q;
+                chosen_slack = slack;
+            }
+            break;
+        }
+    }
+
+    return chosen;
+}
+
+unsigned int Partitioner::allocate(unsigned int utilization, unsigned int bound)
+{
+    bool was_locked = lock();
+
+    int queue = fit(utilization, bound);
+    if(queue < 0) {
+        // There is no way to refuse the thread here, so the task is admitted without guarantees
+        // on the queue with the least load
+        queue = 0;
+        for(unsigned int q = 1; q < Machine::n_cpus(); q++)
+            if(_load[q] < _load[queue])
+                queue = q;
+
+        db<Scheduler<Thread> >(WRN) << "Partitioner::allocate(u=" << utilization << "): task rejected by all queues, admitted without guarantees to queue " << queue << "!" << endl;
+    }
+
+    _load[queue] += utilization;
+
+    unlock(was_locked);
+
+    db<Scheduler<Thread> >(TRC) << "Partitioner::allocate(u=" << utilization << ",b=" << bound << ") => " << queue << " (load=" << _load[queue] << ")" << endl;
+
+    return queue;
+}
+
+void Partitioner::reserve(unsigned int queue, unsigned int utilization)
+{
+    bool was_locked = lock();
+    _load[queue] += utilization;
+    unlock(was_locked);
+}
+
+void Partitioner::release(unsigned int queue, unsigned int utilization)
+{
+    bool was_locked = lock();
+    _load[queue] -= (utilization < _load[queue]) ? utilization : _load[queue];
+    unlock(was_locked);
+}
+
+// Must be called while the task is not in any scheduling queue
+unsigned int Partitioner::migrate(unsigned int queue, unsigned int utilization, unsigned int bound)
+{
+    bool was_locked = lock();
+
+    if(_load[queue] > capacity(queue, bound)) {
+        int to = fit(utilization, bound, queue);
+        if(to >= 0) {
+            db<Scheduler<Thread> >(INF) << "Partitioner::migrate(u=" << utilization << "): queue " << queue << " overloaded at " << DVFS::clock(queue) << " Hz, moving to " << to << endl;
+
+            _load[queue] -= utilization;
+            _load[to] += utilization;
+            queue = to;
+        } else
+            db<Scheduler<Thread> >(WRN) << "Partitioner::migrate(u=" << utilization << "): queue " << queue << " overloaded, but no other queue can take the task!" << endl;
+    }
+
+    unlock(was_locked);
+
+    return queue;
+}
+
+// Moves a task whose queue is chosen elsewhere (e.g. by thermal migration), as long as it still fits in the destination
+bool Partitioner::move(unsigned int from, unsigned int to, unsigned int utilization, unsigned int bound)
+{
+    bool was_locked = lock();
+
+    bool fits = (_load[to] + utilization <= capacity(to, bound));
+    if(fits) {
+        _load[from] -= (utilization < _load[from]) ? utilization : _load[from];
+        _load[to] += utilization;
+    }
+
+    unlock(was_locked);
+
+    return fits;
+}
+
+};
+
 __END_SYS
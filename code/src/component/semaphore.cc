@@ -20,6 +20,19 @@ void Semaphore::p()
 {
     db<Synchronizer>(TRC) << "Semaphore::p(this=" << this << ",value=" << _value << ")" << endl;
 
+    // The first iteration is the fast path, the others spin on SMP
+    int limit = spin_limit();
+    for(int n = 0; n <= limit; n++) {
+        int value = _value;
+        if((value > 0) && (cas(_value, value, value - 1) == value)) {
+            if(n)
+                spun(n);
+            return;
+        }
+    }
+    if(limit)
+        spun(limit);
+
     begin_atomic();
     if(fdec(_value) < 1)
         sleep(); // implicit end_atomic()
@@ -32,6 +45,11 @@ void Semaphore::v()
 {
     db<Synchronizer>(TRC) << "Semaphore::v(this=" << this << ",value=" << _value << ")" << endl;
 
+    // No thread sleeps on the semaphore while its value is not negative
+    int value = _value;
+    if((value >= 0) && (cas(_value, value, value + 1) == value))
+        return;
+
     begin_atomic();
     if(finc(_value) < 0)
         wakeup();  // implicit end_atomic()
@@ -0,0 +1,119 @@
+// EPOS Sequence Lock Component Microbenchmark
+
+// The thread on CPU 0 keeps updating a per-CPU-like snapshot record, while one thread on each of the other CPUs
+// keeps reading it, for a fixed time. The record is guarded by an RW_Lock and then by a Seqlock. Every read
+// checks the record's invariant (the checksum matches the fields), which a torn read would break.
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+#include <rw_lock.h>
+#include <seqlock.h>
+#include <tsc.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Build>::CPUS;
+const unsigned int DURATION = 200; // ms per run
+const unsigned int PAUSE = 1000;   // iterations between updates
+
+struct Snapshot
+{
+    unsigned int frequency;
+    unsigned int temperature;
+    unsigned long long time_stamp;
+    unsigned int checksum;
+};
+
+OStream cout;
+
+unsigned long long operations[CPUS];
+unsigned long long errors[CPUS];
+volatile TSC::Time_Stamp deadline;
+
+RW_Lock rw_lock;
+Snapshot guarded;
+Seqlock<Snapshot> sequenced;
+
+Snapshot snapshot(unsigned int n)
+{
+    Snapshot s;
+    s.frequency = n;
+    s.temperature = n * 3;
+    s.time_stamp = TSC::time_stamp();
+    s.checksum = s.frequency + s.temperature + static_cast<unsigned int>(s.time_stamp);
+    return s;
+}
+
+bool consistent(const Snapshot & s) { return s.checksum == s.frequency + s.temperature + static_cast<unsigned int>(s.time_stamp); }
+
+Snapshot read(RW_Lock * l) { l->read_lock(); Snapshot s = guarded; l->read_unlock(); return s; }
+void write(RW_Lock * l, const Snapshot & s) { l->write_lock(); guarded = s; l->write_unlock(); }
+
+Snapshot read(Seqlock<Snapshot> * l) { return l->read(); }
+void write(Seqlock<Snapshot> * l, const Snapshot & s) { l->write(s); }
+
+template<typename Lock>
+int writer(Lock * lock)
+{
+    for(unsigned int n = 0; TSC::time_stamp() < deadline; n++) {
+        write(lock, snapshot(n));
+        operations[0]++;
+        for(volatile unsigned int i = 0; i < PAUSE; i++);
+    }
+
+    return 0;
+}
+
+template<typename Lock>
+int reader(Lock * lock, unsigned int cpu)
+{
+    while(TSC::time_stamp() < deadline) {
+        if(!consistent(read(lock)))
+            errors[cpu]++;
+        operations[cpu]++;
+    }
+
+    return 0;
+}
+
+template<typename Lock>
+void run(const char * name, Lock * lock)
+{
+    for(unsigned int n = 2; n <= Machine::n_cpus(); n *= 2) {
+        for(unsigned int i = 0; i < n; i++)
+            operations[i] = errors[i] = 0;
+        write(lock, snapshot(0));
+        deadline = TSC::time_stamp() + DURATION * (TSC::frequency() / 1000);
+
+        Thread * threads[CPUS];
+        threads[0] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, 0)), &writer<Lock>, lock);
+        for(unsigned int i = 1; i < n; i++)
+            threads[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, i)), &reader<Lock>, lock, i);
+        for(unsigned int i = 0; i < n; i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        unsigned long long reads = 0;
+        unsigned long long wrong = 0;
+        for(unsigned int i = 1; i < n; i++) {
+            reads += operations[i];
+            wrong += errors[i];
+        }
+
+        cout << name << " on " << n << " CPUs: writes=" << operations[0] << ", reads=" << reads << " (" << reads / DURATION << "/ms), inconsistent reads=" << wrong << endl;
+    }
+}
+
+int main()
+{
+    cout << "Sequence Lock Microbenchmark (" << Machine::n_cpus() << " CPUs, " << DURATION << " ms per run, 1 writer and n-1 readers)" << endl;
+
+    run("RW_Lock", &rw_lock);
+    run("Seqlock", &sequenced);
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
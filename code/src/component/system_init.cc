@@ -2,6 +2,8 @@
 
 #include <system.h>
 #include <alarm.h>
+#include <dvfs.h>
+#include <trace.h>
 
 __BEGIN_SYS
 
@@ -15,6 +17,14 @@ void System::init()
 
     if(Traits<Thread>::enabled)
         Thread::init();
+
+    if(Trace::enabled)
+        Trace::init();
+
+    if(DVFS::enabled)
+        DVFS::init();
+    else if(Traits<Thread>::monitored)
+        DVFS::monitor();
 }
 
 __END_SYS
@@ -4,6 +4,9 @@
 #include <system.h>
 #include <thread.h>
 #include <alarm.h> // for FCFS
+#include <trace.h>
+#include <dvfs.h>
+#include <futex.h>
 
 // This_Thread class attributes
 __BEGIN_UTIL
@@ -13,22 +16,19 @@ __END_UTIL
 __BEGIN_SYS
 
 // Class attributes
-int Thread::_tempPos[Traits<Build>::CPUS];
-int Thread::_graficoTemp[Traits<Build>::CPUS][2000];
-int Thread::_graficoInst[Traits<Build>::CPUS][2000];
-int Thread::_graficoMiss[Traits<Build>::CPUS][2000];
-int Thread::_cpu_temperature[Traits<Build>::CPUS];
 volatile unsigned int Thread::_thread_count;
 Scheduler_Timer * Thread::_timer;
 Scheduler<Thread> Thread::_scheduler;
-Spin Thread::_lock;
+Spin Thread::_lock[Thread::LOCKS];
+volatile TSC::Time_Stamp Thread::_idle_time[Traits<Build>::CPUS];
+volatile TSC::Time_Stamp Thread::_halted[Traits<Build>::CPUS];
+Thread::Counters Thread::_checkpoint[Traits<Build>::CPUS];
 Spin Thread::_print_lock;
-bool Thread::_fim;
 
 // Methods
 void Thread::constructor_prologue(const Color & color, unsigned int stack_size)
 {
-    lock();
+    lock_all();
 
     _thread_count++;
     _scheduler.insert(this);
@@ -57,16 +57,21 @@ void Thread::constructor_epilogue(const Log_Addr & entry, unsigned int stack_siz
     if((_state != READY) && (_state != RUNNING))
         _scheduler.suspend(this);
 
-    if(preemptive && (_state == READY) && (_link.rank() != IDLE))
+    if(preemptive && (_state == READY) && (_link.rank() != IDLE)) {
+        release_all_but(_link.rank().queue());
         reschedule(_link.rank().queue());
-    else
-        unlock();
+    } else
+        unlock_all();
 }
 
 
 Thread::~Thread()
 {
-    lock();
+    // Futex's buckets are locked before the threads' lock (see Futex::wait()), so a waiter is taken out of them first
+    if(_futex)
+        Futex::abandon(this);
+
+    lock_all();
 
     db<Thread>(TRC) << "~Thread(this=" << this
                     << ",state=" << _state
@@ -78,6 +83,9 @@ Thread::~Thread()
     // The running thread cannot delete itself!
     assert(_state != RUNNING);
 
+    // Give the utilization reserved by partitioned criteria back
+    criterion().unpartition();
+
     switch(_state) {
     case RUNNING:  // For switch completion only: the running thread would have deleted itself! Stack wouldn't have been released!
         exit(-1);
@@ -106,10 +114,13 @@ Thread::~Thread()
         delete _user_stack;
     }
 
-    if(_joining)
-        _joining->resume();
+    if(_joining) {
+        _joining->_state = READY;
+        _scheduler.resume(_joining);
+        _joining = 0;
+    }
 
-    unlock();
+    unlock_all();
 
     delete _stack;
 }
@@ -117,32 +128,100 @@ Thread::~Thread()
 
 void Thread::priority(const Priority & c)
 {
-    lock();
+    lock_all();
 
     db<Thread>(TRC) << "Thread::priority(this=" << this << ",prio=" << c << ")" << endl;
 
     unsigned int old_cpu = _link.rank().queue();
 
+    // The thread must leave the scheduler before its rank changes, since ordered queues locate it by rank
+    // Only READY threads are in the scheduler (suspended and waiting ones are just re-ranked)
+    if(_state == READY)
+        _scheduler.remove(this);
+
     _link.rank(Criterion(c));
 
-    if(_state != RUNNING) {
-        _scheduler.remove(this);
+    if(_state == READY)
         _scheduler.insert(this);
-    }
 
     if(preemptive) {
+        release_all_but(old_cpu);
         reschedule(old_cpu);
         if(smp) {
-            lock();
+            lock(_link.rank().queue());
             reschedule(_link.rank().queue());
         }
+    } else
+        unlock_all();
+}
+
+
+// Changes only the priority of the criterion, so the thread keeps its queue, deadline, etc.; for Inheritance_Mutex,
+// whose lock must be held, since a waiting thread is also moved within the mutex's queue
+void Thread::inherit(int priority)
+{
+    assert(locked());
+
+    lock_all();
+
+    db<Thread>(TRC) << "Thread::inherit(this=" << this << ",prio=" << _link.rank() << "=>" << priority << ")" << endl;
+
+    bool queued = (_state == READY) || ((_state == WAITING) && _blocker);
+    if(_state == READY)
+        _scheduler.remove(this);
+    else if(queued)
+        _waiting->remove(&_link);
+
+    const_cast<Criterion &>(_link.rank())._priority = priority;
+
+    if(_state == READY)
+        _scheduler.insert(this);
+    else if(queued)
+        _waiting->insert(&_link);
+
+    unsigned int queue = _link.rank().queue();
+    release_all_but(queue);
+    release(queue);
+
+    // A ready thread raised above the one running on its CPU must preempt it (the caller takes care of its own CPU)
+    if(preemptive && smp && (_state == READY) && (queue != Machine::cpu_id()))
+        IC::ipi_send(queue, IC::INT_RESCHEDULER);
+}
+
+
+// Might be called with interrupts disabled (e.g. by a handler), so their state is restored as found
+Thread::Counters Thread::counters() const
+{
+    bool was_locked = locked();
+    lock();
+
+    Counters counters = _counters;
+
+    if(monitored && (this == running())) {
+        const Counters & checkpoint = _checkpoint[Machine::cpu_id()];
+
+        unsigned long long instructions = PMU::read(DVFS::INSTRUCTIONS);
+        unsigned long long cycles = PMU::read(DVFS::CYCLES);
+        unsigned long long llc_misses = PMU::read(DVFS::LLC_MISSES);
+
+        counters.instructions += instructions - checkpoint.instructions;
+        counters.cycles += cycles - checkpoint.cycles;
+        counters.llc_misses += llc_misses - checkpoint.llc_misses;
     }
+
+    release(current_queue());
+    if(!was_locked)
+        CPU::int_enable();
+
+    db<Thread>(TRC) << "Thread::counters(this=" << this << ") => {i=" << counters.instructions << ",c=" << counters.cycles << ",m=" << counters.llc_misses << "}" << endl;
+
+    return counters;
 }
 
 
 int Thread::join()
 {
-    lock();
+    lock_all();
 
     db<Thread>(TRC) << "Thread::join(this=" << this << ",state=" << _state << ")" << endl;
 
@@ -156,7 +235,7 @@ int Thread::join()
         _joining = running();
         _joining->suspend(true);
     } else
-        unlock();
+        unlock_all();
 
     return *reinterpret_cast<int *>(_stack);
 }
@@ -164,26 +243,28 @@ int Thread::join()
 
 void Thread::pass()
 {
-    lock();
+    lock_all();
 
     db<Thread>(TRC) << "Thread::pass(this=" << this << ")" << endl;
 
     Thread * prev = running();
     Thread * next = _scheduler.choose(this);
 
-    if(next)
+    if(next) {
+        release_all_but(current_queue());
         dispatch(prev, next, false);
-    else {
+    } else {
         db<Thread>(WRN) << "Thread::pass => thread (" << this << ") not ready!" << endl;
-        unlock();
+        unlock_all();
     }
 }
 
 
+// "locked" means the caller holds all scheduler locks, since the thread might be in any queue
 void Thread::suspend(bool locked)
 {
     if(!locked)
-        lock();
+        lock_all();
 
     db<Thread>(TRC) << "Thread::suspend(this=" << this << ")" << endl;
 
@@ -194,13 +275,14 @@ void Thread::suspend(bool locked)
 
     Thread * next = running();
 
+    release_all_but(current_queue());
     dispatch(prev, next);
 }
 
 
 void Thread::resume()
 {
-    lock();
+    unsigned int queue = lock_queue(this);
 
     db<Thread>(TRC) << "Thread::resume(this=" << this << ")" << endl;
 
@@ -209,11 +291,13 @@ void Thread::resume()
         _scheduler.resume(this);
 
         if(preemptive)
-            reschedule(_link.rank().queue());
+            reschedule(queue);
+        else
+            unlock(queue);
     } else {
         db<Thread>(WRN) << "Resume called for unsuspended object!" << endl;
 
-        unlock();
+        unlock(queue);
     }
 }
 
@@ -234,7 +318,7 @@ void Thread::yield()
 
 void Thread::exit(int status)
 {
-    lock();
+    lock_all();
 
     db<Thread>(TRC) << "Thread::exit(status=" << status << ") [running=" << running() << "]" << endl;
 
@@ -251,68 +335,110 @@ void Thread::exit(int status)
         prev->_joining = 0;
     }
 
-    dispatch(prev, _scheduler.choose());
+    Thread * next = _scheduler.choose();
+
+    release_all_but(current_queue());
+    dispatch(prev, next);
 }
 
 
-void Thread::sleep(Queue * q)
+// The synchronizer's lock must be held, and is released once the thread is in "q"
+void Thread::sleep(Queue * q, Simple_Spin * lock)
 {
     db<Thread>(TRC) << "Thread::sleep(running=" << running() << ",q=" << q << ")" << endl;
 
-    // lock() must be called before entering this method
     assert(locked());
 
+    Thread::lock();
+
     Thread * prev = running();
     _scheduler.suspend(prev);
     prev->_state = WAITING;
     q->insert(&prev->_link);
     prev->_waiting = q;
 
+    if(smp)
+        lock->release();
+
     dispatch(prev, _scheduler.chosen());
 }
 
 
-void Thread::wakeup(Queue * q)
+// The synchronizer's lock must be held, and is released before rescheduling
+// A waiting thread leaves "q" holding its queue's lock too, so ~Thread() can remove it from "q" under lock_all()
+void Thread::wakeup(Queue * q, Simple_Spin * lock)
 {
     db<Thread>(TRC) << "Thread::wakeup(running=" << running() << ",q=" << q << ")" << endl;
 
-    // lock() must be called before entering this method
     assert(locked());
 
     if(!q->empty()) {
-        Thread * t = q->remove()->object();
+        Thread * t = q->head()->object();
+        unsigned int queue = lock_queue(t);
+
+        q->remove();
         t->_state = READY;
         t->_waiting = 0;
         _scheduler.resume(t);
 
+        if(smp)
+            lock->release();
+
         if(preemptive)
-            reschedule(t->_link.rank().queue());
-    } else
-        unlock();
+            reschedule(queue);
+        else
+            unlock(queue);
+    } else {
+        if(smp)
+            lock->release();
+        CPU::int_enable();
+    }
 }
 
 
-void Thread::wakeup_all(Queue * q)
+// As wakeup(), but CPUs are only rescheduled after the synchronizer's lock is released,
+// since rescheduling the current one might switch to a thread that needs it
+void Thread::wakeup_all(Queue * q, Simple_Spin * lock)
 {
     db<Thread>(TRC) << "Thread::wakeup_all(running=" << running() << ",q=" << q << ")" << endl;
 
-    // lock() must be called before entering this method
     assert(locked());
 
-    if(!q->empty())
-        while(!q->empty()) {
-            Thread * t = q->remove()->object();
-            t->_state = READY;
-            t->_waiting = 0;
-            _scheduler.resume(t);
+    bool pending[Traits<Machine>::CPUS];
+    for(unsigned int i = 0; i < Traits<Machine>::CPUS; i++)
+        pending[i] = false;
+
+    while(!q->empty()) {
+        Thread * t = q->head()->object();
+        unsigned int queue = lock_queue(t);
 
-            if(preemptive) {
-                reschedule(t->_link.rank().queue());
-                lock();
+        q->remove();
+        t->_state = READY;
+        t->_waiting = 0;
+        _scheduler.resume(t);
+
+        release(queue);
+        pending[queue] = true;
+    }
+
+    if(smp)
+        lock->release();
+
+    if(preemptive) {
+        unsigned int cpu = Machine::cpu_id();
+        for(unsigned int i = 0; i < Traits<Machine>::CPUS; i++)
+            if(pending[i] && (i != cpu)) {
+                Thread::lock(i);
+                reschedule(i);
             }
-         }
-    else
-        unlock();
+        if(pending[cpu]) {
+            Thread::lock(cpu);
+            reschedule(cpu);
+            return;
+        }
+    }
+
+    CPU::int_enable();
 }
 
 
@@ -330,14 +456,20 @@ void Thread::reschedule()
 }
 
 
+// The lock of the queue "cpu" designates must be held
 void Thread::reschedule(unsigned int cpu)
 {
-    if(!smp || (cpu == Machine::cpu_id()))
+    if(!smp || (cpu == Machine::cpu_id())) {
+        // For clustered criteria, queues and CPUs are numbered differently
+        if(index(cpu) != index(current_queue())) {
+            release(cpu);
+            lock();
+        }
         reschedule();
-    else {
+    } else {
         db<Scheduler<Thread> >(TRC) << "Thread::reschedule(cpu=" << cpu << ")" << endl;
         IC::ipi_send(cpu, IC::INT_RESCHEDULER);
-        unlock();
+        unlock(cpu);
     }
 }
 
@@ -363,30 +495,6 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
     if(charge) {
         if(Criterion::timed)
             _timer->reset();
-
-        //ADVFS
-        if(Criterion::energy_aware) {
-            unsigned int cpu_id = Machine::cpu_id();
-            _cpu_temperature[cpu_id] = Thermal::temperature();
-            if (_tempPos[cpu_id] == 0)
-                _fim = false;
-            if (!_fim) {
-                if (_tempPos[cpu_id] < 2000) {
-                    _graficoMiss[cpu_id][_tempPos[cpu_id]] = PMU::read(4);
-                    _graficoInst[cpu_id][_tempPos[cpu_id]] = PMU::read(3);
-                    _graficoTemp[cpu_id][_tempPos[cpu_id]] = _cpu_temperature[cpu_id];
-                    _tempPos[cpu_id] += 1;
-                }
-            }
-            //set max temp
-            if(_cpu_temperature[cpu_id] >= 45) {
-                unsigned long new_hz = 896146304;
-                CPU::clock(new_hz);
-                //set min temp
-            } else if (_cpu_temperature[cpu_id] <= 40){
-                CPU::clock(CPU::clock());
-            }
-        }
     }
 
     if(prev != next) {
@@ -398,8 +506,23 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
         db<Thread>(INF) << "prev={" << prev << ",ctx=" << *prev->_context << "}" << endl;
         db<Thread>(INF) << "next={" << next << ",ctx=" << *next->_context << "}" << endl;
 
-        if(smp)
-            _lock.release();
+        Trace::record(Trace::DISPATCH, next);
+
+        if(monitored)
+            account(prev);
+
+        wake_from_idle(Machine::cpu_id()); // an interrupt taken while halted dispatched another thread
+
+        if(DVFS::per_thread)
+            DVFS::dispatch(prev, next);
+
+        // prev stays READY in the list once the lock is released, but its context is only valid once
+        // switch_context() saves it, so other CPUs don't move it meanwhile (see lock())
+        if(smp) {
+            if(Criterion::migratable)
+                prev->_context = 0;
+            _lock[index(current_queue())].release();
+        }
 
         if(multitask && (next->_task != prev->_task))
             next->_task->activate();
@@ -407,36 +530,80 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
         CPU::switch_context(&prev->_context, next->_context);
     } else
         if(smp)
-            _lock.release();
+            _lock[index(current_queue())].release();
 
     // TODO: could this be moved to right after the switch_context?
     CPU::int_enable();
 }
 
 
+// Locks the queue "t" is in, which might change until the lock is held (e.g. by migration)
+unsigned int Thread::lock_queue(Thread * t)
+{
+    while(true) {
+        unsigned int queue = t->_link.rank().queue();
+        lock(queue);
+        if(t->_link.rank().queue() == queue)
+            return queue;
+        release(queue);
+    }
+}
+
+
+// Charges "prev" with the events counted since the previous context switch on this CPU
+// The channels are programmed by DVFS (see DVFS::monitor()) and read with rdpmc, so this is cheap
+void Thread::account(Thread * prev)
+{
+    Counters & checkpoint = _checkpoint[Machine::cpu_id()];
+
+    unsigned long long instructions = PMU::read(DVFS::INSTRUCTIONS);
+    unsigned long long cycles = PMU::read(DVFS::CYCLES);
+    unsigned long long llc_misses = PMU::read(DVFS::LLC_MISSES);
+
+    prev->_counters.instructions += instructions - checkpoint.instructions;
+    prev->_counters.cycles += cycles - checkpoint.cycles;
+    prev->_counters.llc_misses += llc_misses - checkpoint.llc_misses;
+
+    checkpoint.instructions = instructions;
+    checkpoint.cycles = cycles;
+    checkpoint.llc_misses = llc_misses;
+}
+
+
+// Ends the idle interval of "cpu", either when idle() resumes or when an interrupt taken while halted dispatches
+// another thread, so the threads it runs before idle() gets the CPU back are not accounted as idle time
+void Thread::wake_from_idle(unsigned int cpu)
+{
+    if(_halted[cpu]) {
+        _idle_time[cpu] += TSC::time_stamp() - _halted[cpu];
+        _halted[cpu] = 0;
+    }
+}
+
+
 int Thread::idle()
 {
     while(_thread_count > Machine::n_cpus()) { // someone else besides idles
         if(Traits<Thread>::trace_idle)
             db<Thread>(TRC) << "Thread::idle(CPU=" << Machine::cpu_id() << ",this=" << running() << ")" << endl;
-                
-        if(Criterion::energy_aware) {
-        	unsigned int cpu_id = Machine::cpu_id();
-            _cpu_temperature[cpu_id] = Thermal::temperature();
-            if (_tempPos[cpu_id] == 0)
-                _fim = false;
-
-            if (!_fim) {
-                if (_tempPos[cpu_id] < 2000) {
-                    _graficoMiss[cpu_id][_tempPos[cpu_id]] = PMU::read(4);
-                    _graficoInst[cpu_id][_tempPos[cpu_id]] = PMU::read(3);
-                    _graficoTemp[cpu_id][_tempPos[cpu_id]] = _cpu_temperature[cpu_id];
-                    _tempPos[cpu_id] += 1;
-                }
-            }
+
+        // Before halting, look for work queued on other CPUs
+        Thread * stolen = Stealer::steal();
+        if(stolen) {
+            Trace::record(Trace::MIGRATION, stolen);
+            yield();
+            continue;
         }
+
+        // Account for the time spent halted, so DVFS governors can tell how busy each CPU is
+        // With tickless idle, the timer only interrupts the CPU at its next event (see Timer::halt())
+        Alarm::Tick alarm = Timer::tickless ? Alarm::next() : 0;
+        CPU::int_disable();
+        unsigned int cpu = Machine::cpu_id();
+        _halted[cpu] = TSC::time_stamp();
+        Timer::halt(alarm);
+        wake_from_idle(cpu);
         CPU::int_enable();
-        CPU::halt();
         if(_scheduler.schedulables() > 0) // A thread might have been woken up by another CPU
             yield();
     }
@@ -458,10 +625,15 @@ int Thread::idle()
 
 __END_SYS
 
-// Id forwarder to the spin lock
+// Id forwarders to the spin locks
 __BEGIN_UTIL
 unsigned int This_Thread::id()
 {
     return _not_booting ? reinterpret_cast<volatile unsigned int>(Thread::self()) : Machine::cpu_id() + 1;
 }
+
+unsigned int This_Thread::cpu()
+{
+    return Machine::cpu_id();
+}
 __END_UTIL
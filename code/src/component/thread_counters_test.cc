@@ -0,0 +1,82 @@
+// EPOS Thread Performance Counters Test Program
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+
+using namespace EPOS;
+
+const int iterations = 100;
+const unsigned int array_size = 1024 * 1024; // larger than the LLC of the targets we run on
+const unsigned int stride = 64;
+
+volatile char array[array_size];
+
+OStream cout;
+
+// Both kinds of workers share the CPU, so their counts only differ if they are kept per thread
+int compute(int n)
+{
+    for(int i = 0; i < iterations; i++) {
+        for(volatile int j = 0; j < 10000; j++);
+        if(!(i % 10))
+            Thread::yield();
+    }
+
+    return n;
+}
+
+int memory(int n)
+{
+    for(int i = 0; i < iterations; i++) {
+        for(unsigned int j = 0; j < array_size; j += stride)
+            array[j]++;
+        if(!(i % 10))
+            Thread::yield();
+    }
+
+    return n;
+}
+
+void print(const char * name, const Thread::Counters & c)
+{
+    cout << name << ": instructions=" << c.instructions << " cycles=" << c.cycles << " llc_misses=" << c.llc_misses;
+    if(c.cycles)
+        cout << " IPC=" << c.instructions * 1000 / c.cycles << "/1000";
+    if(c.instructions)
+        cout << " MPKI=" << c.llc_misses * 1000 / c.instructions;
+    cout << endl;
+}
+
+int main()
+{
+    cout << "Thread Performance Counters test" << endl;
+
+    Thread::Counters before = Thread::self()->counters();
+
+    Thread * c = new Thread(&compute, 0);
+    Thread * m = new Thread(&memory, 1);
+
+    c->join();
+    m->join();
+
+    Thread::Counters after = Thread::self()->counters();
+    Thread::Counters cc = c->counters();
+    Thread::Counters mc = m->counters();
+
+    print("compute", cc);
+    print("memory", mc);
+    print("main", after);
+
+    cout << "compute consumed " << c->consumed() << " us at the nominal clock" << endl;
+
+    bool ok = (after.instructions >= before.instructions) && cc.instructions && mc.instructions && (mc.llc_misses > cc.llc_misses) && cc.cycles;
+    cout << (ok ? "Counts look sane" : "Counts are NOT per thread!") << endl;
+
+    delete c;
+    delete m;
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
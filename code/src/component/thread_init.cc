@@ -23,39 +23,6 @@ void Thread::init()
             IC::int_vector(IC::INT_RESCHEDULER, rescheduler);
         IC::enable(IC::INT_RESCHEDULER);
     }
-
-    //_cpu_temperature[Machine::cpu_id()] = Thermal::temperature();
-
-    //Inicialization of PMU Channels to the statistics collecting in energy aware policies
-    // Capturing INSTRUCTION, LLC_MISS, DVS_CLOCK.
-    if(Criterion::energy_aware) {
-    	_cpu_temperature[Machine::cpu_id()] = Thermal::temperature();
-        
-        APIC::disable_perf_int();
-
-        PMU::stop(3);
-        PMU::stop(4);
-        PMU::stop(5);
-        
-        PMU::reset(3);
-        PMU::reset(4);
-        PMU::reset(5);
-
-        PMU::write(3, 0);
-        PMU::write(4, 0);
-        PMU::write(5, 0);
-
-        PMU::config(3, PMU::INSTRUCTION);
-        PMU::config(4, PMU::LLC_MISS);
-        PMU::config(5, PMU::DVS_CLOCK);
-    
-        PMU::start(3);
-        PMU::start(4);
-        PMU::start(5);
-            
-        APIC::enable_perf_int();
-    }
-
 }
 
 __END_SYS
@@ -0,0 +1,155 @@
+// EPOS Trace Component Implementation
+
+#include <trace.h>
+#include <thread.h>
+#include <dvfs.h>
+
+__BEGIN_SYS
+
+// Class attributes
+Trace::Ring Trace::_ring[Trace::CPUS];
+
+static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+
+// Class methods
+// Must be called with interrupts disabled, so nothing else writes to this CPU's ring
+void Trace::write(const Event & event, const void * thread)
+{
+    unsigned int cpu = Machine::cpu_id();
+    Ring & ring = _ring[cpu];
+
+    if(!ring.records) // not initialized yet
+        return;
+
+    unsigned int head = ring.head;
+    if((MODE == STOP) && (head - ring.tail >= RECORDS)) {
+        ring.lost++;
+        return;
+    }
+
+    Record * r = &ring.records[head % RECORDS];
+    r->time_stamp = TSC::time_stamp();
+    if(DVFS::enabled) {
+        r->instructions = PMU::read(DVFS::INSTRUCTIONS);
+        r->cycles = PMU::read(DVFS::CYCLES);
+        r->llc_misses = PMU::read(DVFS::LLC_MISSES);
+        r->clock = DVFS::clock(cpu);
+        r->temperature = DVFS::temperature(cpu);
+    } else {
+        r->instructions = 0;
+        r->cycles = 0;
+        r->llc_misses = 0;
+        r->clock = CPU::clock();
+        r->temperature = 0;
+    }
+    unsigned int ready = Thread::_scheduler.schedulables();
+    r->ready = (ready > 255) ? 255 : ready;
+    r->thread = reinterpret_cast<unsigned int>(thread);
+    r->event = event;
+    r->cpu = cpu;
+
+    // The record must be complete before it becomes visible to drain()
+    ASM("" : : : "memory");
+    ring.head = head + 1;
+}
+
+
+// Only one CPU may drain a given ring at a time
+unsigned int Trace::drain(unsigned int cpu, Record * buffer, unsigned int n)
+{
+    Ring & ring = _ring[cpu];
+
+    if(!ring.records)
+        return 0;
+
+    unsigned int head = ring.head;
+    unsigned int tail = ring.tail;
+
+    // In OVERWRITE mode, the writer might have lapped the reader
+    if(head - tail > RECORDS) {
+        ring.lost += head - tail - RECORDS;
+        tail = head - RECORDS;
+    }
+
+    unsigned int count = head - tail;
+    if(count > n)
+        count = n;
+
+    for(unsigned int i = 0; i < count; i++)
+        buffer[i] = ring.records[(tail + i) % RECORDS];
+
+    ASM("" : : : "memory");
+
+    // Records the writer might have reused while they were being copied are discarded
+    unsigned int discarded = 0;
+    if(MODE == OVERWRITE) {
+        unsigned int now = ring.head;
+        if(now - tail >= RECORDS) {
+            discarded = now + 1 - RECORDS - tail;
+            if(discarded > count)
+                discarded = count;
+            for(unsigned int i = discarded; i < count; i++)
+                buffer[i - discarded] = buffer[i];
+            ring.lost += discarded;
+        }
+    }
+
+    ring.tail = tail + count;
+
+    db<Trace>(TRC) << "Trace::drain(cpu=" << cpu << ",n=" << n << ") => " << count - discarded << " (lost=" << ring.lost << ")" << endl;
+
+    return count - discarded;
+}
+
+
+void Trace::dump(OStream & out)
+{
+    static const unsigned int CHUNK = 16;
+
+    Record buffer[CHUNK];
+    char line[(sizeof(Record) + 2) / 3 * 4 + 1];
+
+    out << "#H " << VERSION << " " << TSC::frequency() << " " << Machine::n_cpus() << " " << sizeof(Record) << endl;
+
+    for(unsigned int cpu = 0; cpu < Machine::n_cpus(); cpu++)
+        for(unsigned int n; (n = drain(cpu, buffer, CHUNK)) > 0;)
+            for(unsigned int i = 0; i < n; i++) {
+                encode(buffer[i], line);
+                out << "#T " << line << endl;
+            }
+
+    for(unsigned int cpu = 0; cpu < Machine::n_cpus(); cpu++)
+        out << "#L " << cpu << " " << lost(cpu) << endl;
+}
+
+
+// Base64 (RFC 4648) keeps records compact while printable
+void Trace::encode(const Record & record, char * line)
+{
+    const unsigned char * data = reinterpret_cast<const unsigned char *>(&record);
+    unsigned int i = 0;
+
+    for(; i + 3 <= sizeof(Record); i += 3, line += 4) {
+        unsigned int group = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        line[0] = base64[(group >> 18) & 0x3f];
+        line[1] = base64[(group >> 12) & 0x3f];
+        line[2] = base64[(group >> 6) & 0x3f];
+        line[3] = base64[group & 0x3f];
+    }
+
+    if(i < sizeof(Record)) {
+        unsigned int group = data[i] << 16;
+        if(i + 1 < sizeof(Record))
+            group |= data[i + 1] << 8;
+        line[0] = base64[(group >> 18) & 0x3f];
+        line[1] = base64[(group >> 12) & 0x3f];
+        line[2] = (i + 1 < sizeof(Record)) ? base64[(group >> 6) & 0x3f] : '=';
+        line[3] = '=';
+        line += 4;
+    }
+
+    *line = '\0';
+}
+
+__END_SYS
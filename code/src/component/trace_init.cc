@@ -0,0 +1,21 @@
+// EPOS Trace Component Initialization
+
+#include <system.h>
+#include <trace.h>
+
+__BEGIN_SYS
+
+// Rings are allocated from the system heap, so nothing is spent on traces unless they are enabled
+void Trace::init()
+{
+    db<Init, Trace>(TRC) << "Trace::init(records=" << RECORDS << ",mode=" << ((MODE == OVERWRITE) ? "overwrite" : "stop") << ")" << endl;
+
+    for(unsigned int i = 0; i < Machine::n_cpus(); i++) {
+        _ring[i].head = 0;
+        _ring[i].tail = 0;
+        _ring[i].lost = 0;
+        _ring[i].records = new (SYSTEM) Record[RECORDS];
+    }
+}
+
+__END_SYS
@@ -0,0 +1,72 @@
+// EPOS Trace Component Test Program
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+#include <alarm.h>
+#include <trace.h>
+
+using namespace EPOS;
+
+const int iterations = 1000;
+const unsigned int chunk = 64;
+
+Trace::Record records[chunk];
+
+OStream cout;
+
+int worker(int n)
+{
+    for(int i = 0; i < iterations; i++) {
+        Trace::record(Trace::USER, Thread::self());
+        for(volatile int j = 0; j < 10000; j++);
+        if(!(i % 100))
+            Thread::yield();
+    }
+
+    return n;
+}
+
+int main()
+{
+    cout << "Trace test" << endl;
+
+    Thread * workers[Traits<Build>::CPUS];
+    for(unsigned int i = 0; i < Machine::n_cpus(); i++)
+        workers[i] = new Thread(&worker, static_cast<int>(i));
+
+    Delay wait(500000);
+
+    for(unsigned int i = 0; i < Machine::n_cpus(); i++) {
+        workers[i]->join();
+        delete workers[i];
+    }
+
+    // Drain the rings in chunks while the system keeps recording
+    for(unsigned int cpu = 0; cpu < Machine::n_cpus(); cpu++) {
+        unsigned int total = 0;
+        unsigned int events[Trace::USER + 1] = {0};
+        bool ordered = true;
+        TSC::Time_Stamp last = 0;
+
+        for(unsigned int n; (n = Trace::drain(cpu, records, chunk)) > 0; total += n)
+            for(unsigned int i = 0; i < n; i++) {
+                if(records[i].time_stamp < last)
+                    ordered = false;
+                last = records[i].time_stamp;
+                if(records[i].event <= Trace::USER)
+                    events[records[i].event]++;
+                if(records[i].cpu != cpu)
+                    ordered = false;
+            }
+
+        cout << "CPU " << cpu << ": " << total << " records (lost=" << Trace::lost(cpu) << ")"
+             << " samples=" << events[Trace::SAMPLE] << " dispatches=" << events[Trace::DISPATCH]
+             << " clocks=" << events[Trace::CLOCK] << " migrations=" << events[Trace::MIGRATION]
+             << " user=" << events[Trace::USER] << (ordered ? "" : " OUT OF ORDER!") << endl;
+    }
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
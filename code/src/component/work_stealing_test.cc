@@ -0,0 +1,57 @@
+// EPOS Work Stealing Test Program
+
+// All workers are queued on CPU 0 at creation. Those with soft affinity should be
+// stolen by the other CPUs once they go idle, while the hard-pinned one must stay.
+
+#include <utility/ostream.h>
+#include <machine.h>
+#include <thread.h>
+
+using namespace EPOS;
+
+const int WORKERS = 6;
+const int iterations = 20;
+
+Thread * worker[WORKERS + 1];
+volatile unsigned int cpus[WORKERS + 1]; // bitmap of the CPUs each worker ran on
+
+OStream cout;
+
+int work(int n)
+{
+    for(int i = 0; i < iterations; i++) {
+        cpus[n] |= 1 << Machine::cpu_id();
+        for(volatile int j = 0; j < 1000000; j++);
+    }
+
+    return n;
+}
+
+int main()
+{
+    cout << "Work stealing test (" << Machine::n_cpus() << " CPUs)" << endl;
+
+    for(int i = 0; i < WORKERS; i++)
+        worker[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, 0, false)), &work, i);
+    worker[WORKERS] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, 0)), &work, WORKERS);
+
+    for(int i = 0; i <= WORKERS; i++)
+        worker[i]->join();
+
+    bool ok = (cpus[WORKERS] == 1);
+    unsigned int used = 0;
+    for(int i = 0; i <= WORKERS; i++) {
+        cout << "Worker " << i << ((i == WORKERS) ? " (pinned)" : " (soft)") << " ran on CPUs " << hex << cpus[i] << dec << endl;
+        used |= cpus[i];
+        delete worker[i];
+    }
+
+    if(Machine::n_cpus() > 1)
+        ok = ok && (used != 1);
+
+    cout << (ok ? "Work was spread and the pinned worker stayed on CPU 0" : "Work stealing FAILED!") << endl;
+
+    cout << "I'm done, bye!" << endl;
+
+    return 0;
+}
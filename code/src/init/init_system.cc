@@ -6,6 +6,7 @@
 #include <address_space.h>
 #include <segment.h>
 #include <pmu.h>
+#include <dvfs.h>
 
 __BEGIN_SYS
 
@@ -30,7 +31,12 @@ public:
             if(Traits<PMU>::enabled)
             PMU::init();		//CPU0 calls PMU::init() inside CPU::init()
 
-            
+            // The governor samples core-local sensors (CPU0 initializes DVFS at System::init())
+            if(DVFS::enabled)
+                DVFS::init();
+            else if(Traits<Thread>::monitored)
+                DVFS::monitor();
+
             return;
         }
 
@@ -1,6 +1,7 @@
 // EPOS PC Interrupt Dispatcher
 
 #include <machine/pc/ic.h>
+#include <timer.h>
 
 extern "C" { void _exit(int s); }
 extern "C" { void __exit(); }
@@ -161,11 +162,11 @@ void IC::entry()
         "        jmp        .GO         \n"
         "        .align 16              \n"
         "        movl        $49, %0    \n"
+        "        jmp        .GO         \n"
+        "        .align 16              \n"
+        "        movl        $50, %0    \n"
         // On a regular PC, only the first 32 exceptions and the subsequent 16 interrupts are useful
-        // We also left two spare entries for multicore IPIs and an interrupt-based system call mechanism
-        //        "        jmp        .GO         \n"
-        //        "        .align 16              \n"
-        //        "        movl        $50, %0    \n"
+        // We also left three spare entries for multicore IPIs (reschedule and frequency) and an interrupt-based system call mechanism
         //        "        jmp        .GO         \n"
         //        "        .align 16              \n"
         //        "        movl        $51, %0    \n"
@@ -790,6 +791,25 @@ void IC::entry()
         "        iret                   \n" : : "m"(id), "c"(dispatch));
 };
 
+// A CPU halted in tickless mode ticks again before any handler can dispatch another thread there (the timer's
+// own handler does it itself, see Timer::int_handler())
+void IC::dispatch(unsigned int i)
+{
+    bool not_spurious = true;
+    if((i >= INT_FIRST_HARD) && (i <= INT_LAST_HARD))
+        not_spurious = eoi(i);
+    if(not_spurious) {
+        if((i != INT_TIMER) || Traits<IC>::hysterically_debugged)
+            db<IC>(TRC) << "IC::dispatch(i=" << i << ")" << endl;
+        if(i != INT_TIMER)
+            Timer::awake();
+        _int_vector[i](i);
+    } else {
+        if(i != INT_LAST_HARD)
+            db<IC>(TRC) << "IC::spurious interrupt (" << i << ")" << endl;
+    }
+}
+
 // Default logical handler
 void IC::int_not(const Interrupt_Id & i)
 {
@@ -8,21 +8,163 @@ __BEGIN_SYS
 
 // Class attributes
 Timer * Timer::_channels[CHANNELS];
+volatile Timer::Tick Timer::_horizon[CPUS];
+volatile TSC::Time_Stamp Timer::_halted[CPUS];
+volatile int Timer::_kicked[CPUS];
+volatile Timer::Count Timer::_split[CPUS];
+volatile bool Timer::_oneshot[CPUS];
 
 // Class methods
+void Timer::halt(const Tick & alarm)
+{
+    unsigned int cpu = Machine::cpu_id();
+
+    Tick ticks = 0xffffffffU / (Engine::clock() / FREQUENCY); // the longest the engine can count
+    if(alarm < ticks) // each CPU handles its own alarm queue
+        ticks = alarm;
+    if(handles_user(cpu)) // USER is called at every tick, and Alarm::elapsed() only advances with this CPU's ticks
+        ticks = 1;
+    if(_channels[GOVERNOR] && (static_cast<Tick>(_channels[GOVERNOR]->_current[cpu]) < ticks))
+        ticks = _channels[GOVERNOR]->_current[cpu];
+    if(_channels[SCHEDULER] && (static_cast<Tick>(_channels[SCHEDULER]->_current[cpu]) < ticks))
+        ticks = _channels[SCHEDULER]->_current[cpu];
+    if(high_resolution && (_split[cpu] || _oneshot[cpu])) // the timer is already one-shot for a precise event
+        ticks = 1;
+
+    if(tickless && (ticks > 1)) {
+        // A wakeup() after "alarm" was read but before _horizon is visible sets _kicked and finds no one to interrupt
+        _horizon[cpu] = ticks;
+        if(CPU::cas(_kicked[cpu], 1, 0)) {
+            _horizon[cpu] = 0;
+            return;
+        }
+
+        _halted[cpu] = TSC::time_stamp();
+        Engine::config(0, Engine::clock() / FREQUENCY * ticks, true, false);
+
+        db<Timer>(TRC) << "Timer::halt(a=" << alarm << ") => {ticks=" << ticks << "}" << endl;
+    }
+
+    CPU::int_enable();
+    CPU::halt();
+    CPU::int_disable();
+
+    if(_horizon[cpu]) // woken up by a spurious interrupt (see IC::dispatch())
+        resume(false);
+}
+
+
+void Timer::wakeup(unsigned int cpu)
+{
+    if(!tickless || (cpu == Machine::cpu_id()))
+        return;
+
+    CPU::tsl(_kicked[cpu]);
+    if(_horizon[cpu])
+        IC::ipi_send(cpu, IC::INT_RESCHEDULER);
+}
+
+
+void Timer::precise(const TSC::Time_Stamp & deadline)
+{
+    if(!high_resolution)
+        return;
+
+    unsigned int cpu = Machine::cpu_id();
+
+    TSC::Time_Stamp now = TSC::time_stamp();
+    TSC::Time_Stamp delta = (deadline > now) ? deadline - now : 0;
+    if(delta >= TSC::frequency() / FREQUENCY)
+        return;
+
+    Count next = Engine::left(0);       // until the next interrupt
+    Count tick = next + _split[cpu];    // until the next tick
+    Count count = delta * Engine::clock() / TSC::frequency();
+    if(count < Engine::clock() / 1000000) // at least a microsecond
+        count = Engine::clock() / 1000000;
+    if(count >= next) // the tick or an earlier precise event come first
+        return;
+
+    db<Timer>(TRC) << "Timer::precise(d=" << deadline << ") => {count=" << count << ",tick=" << tick << "}" << endl;
+
+    _split[cpu] = tick - count;
+    Engine::config(0, count, true, false);
+}
+
+
+// Restores the periodic tick and catches the channels up with the ticks skipped while halted
+// If "tick" is true, the one-shot expired and int_handler() accounts for the last tick itself
+void Timer::resume(bool tick)
+{
+    unsigned int cpu = Machine::cpu_id();
+    Tick ticks = _horizon[cpu];
+    _horizon[cpu] = 0;
+
+    Engine::config(0, Engine::clock() / FREQUENCY);
+
+    Tick skipped = ticks - 1;
+    if(!tick) {
+        TSC::Time_Stamp period = TSC::frequency() / FREQUENCY;
+        TSC::Time_Stamp elapsed = (TSC::time_stamp() - _halted[cpu] + period / 2) / period;
+        if(elapsed < static_cast<TSC::Time_Stamp>(skipped))
+            skipped = elapsed;
+    }
+
+    db<Timer>(TRC) << "Timer::resume(t=" << tick << ") => {ticks=" << ticks << ",skipped=" << skipped << "}" << endl;
+
+    if(_channels[GOVERNOR])
+        _channels[GOVERNOR]->_current[cpu] -= skipped;
+    if(_channels[SCHEDULER])
+        _channels[SCHEDULER]->_current[cpu] -= skipped;
+
+    // No request was due in between, so Alarm only needs to count them
+    if(_channels[ALARM])
+        for(Tick i = 0; i < skipped; i++)
+            _channels[ALARM]->_handler(IC::INT_TIMER);
+}
+
+
 void Timer::int_handler(const Interrupt_Id & i)
 {
+    if(high_resolution) {
+        unsigned int cpu = Machine::cpu_id();
+
+        Count split = _split[cpu];
+        if(split) { // a precise event, the tick goes on one-shot
+            Engine::config(0, split, true, false);
+            _split[cpu] = 0;
+            _oneshot[cpu] = true;
+            if(_channels[PRECISE])
+                _channels[PRECISE]->_handler(i);
+            return;
+        }
+
+        if(_oneshot[cpu]) { // the end of a split tick
+            Engine::config(0, Engine::clock() / FREQUENCY);
+            _oneshot[cpu] = false;
+        }
+    }
+
+    if(tickless && _horizon[Machine::cpu_id()])
+        resume(true);
+
+    // DVFS must be serviced before the scheduler, since time_slicer() might not return before the next quantum
+    if(_channels[GOVERNOR] && (--_channels[GOVERNOR]->_current[Machine::cpu_id()] <= 0)) {
+        _channels[GOVERNOR]->_current[Machine::cpu_id()] = _channels[GOVERNOR]->_initial;
+        _channels[GOVERNOR]->_handler(i);
+    }
+
     if(_channels[SCHEDULER] && (--_channels[SCHEDULER]->_current[Machine::cpu_id()] <= 0)) {
         _channels[SCHEDULER]->_current[Machine::cpu_id()] = _channels[SCHEDULER]->_initial;
         _channels[SCHEDULER]->_handler(i);
     }
 
-    if((!Traits<System>::multicore || (Traits<System>::multicore && (Machine::cpu_id() == 0))) && _channels[ALARM]) {
-        _channels[ALARM]->_current[0] = _channels[ALARM]->_initial;
+    if(_channels[ALARM]) {
+        _channels[ALARM]->_current[Machine::cpu_id()] = _channels[ALARM]->_initial;
         _channels[ALARM]->_handler(i);
     }
 
-    if((!Traits<System>::multicore || (Traits<System>::multicore && (Machine::cpu_id() == 0))) && _channels[USER]) {
+    if(handles_user(Machine::cpu_id()) && _channels[USER]) {
         if(_channels[USER]->_retrigger)
             _channels[USER]->_current[0] = _channels[USER]->_initial;
         _channels[USER]->_handler(i);
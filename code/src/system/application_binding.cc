@@ -26,8 +26,12 @@ extern "C" {
     // Utility methods that differ from kernel and user space.
     // Heap
     static _UTIL::Simple_Spin _heap_spin;
-    void _heap_lock() { _heap_spin.acquire(); }
-    void _heap_unlock() { _heap_spin.release();}
+    bool _heap_lock() { _heap_spin.acquire(); return false; }
+    void _heap_unlock(bool) { _heap_spin.release();}
+
+    // Tasks can't disable interrupts, so their heap caches are all CPU 0's and take the heap lock
+    bool _heap_cache_lock(unsigned int * cpu) { _heap_spin.acquire(); *cpu = 0; return false; }
+    void _heap_cache_unlock(bool) { _heap_spin.release(); }
 }
 
 __USING_SYS;
@@ -16,6 +16,7 @@ Agent::Member Agent::_handlers[] = {&Agent::handle_thread,
                                     &Agent::handle_mutex,
                                     &Agent::handle_semaphore,
                                     &Agent::handle_condition,
+                                    &Agent::handle_futex,
                                     &Agent::handle_clock,
                                     &Agent::handle_alarm,
                                     &Agent::handle_chronometer,
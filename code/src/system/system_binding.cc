@@ -43,13 +43,31 @@ extern "C" {
     }
 
     // Heap
-    static Spin _heap_spin;
-    void _heap_lock() {
-        _heap_spin.acquire();
+    // Interrupts are disabled before spinning, so a CPU never waits for a lock held by a thread it preempted.
+    // The heap is also used with interrupts already disabled (e.g. by ~Thread under Thread::lock_all()), so the
+    // lock returns their previous state, which the caller hands back to the unlock to be restored.
+    static Heap_Spin _heap_spin;
+    bool _heap_lock() {
+        bool was_locked = CPU::int_disabled();
         CPU::int_disable();
+        _heap_spin.acquire();
+        return was_locked;
     }
-    void _heap_unlock() {
+    void _heap_unlock(bool was_locked) {
         _heap_spin.release();
-        CPU::int_enable();
+        if(!was_locked)
+            CPU::int_enable();
+    }
+
+    // Each CPU's heap caches are only handled by itself, so disabling interrupts suffices
+    bool _heap_cache_lock(unsigned int * cpu) {
+        bool was_locked = CPU::int_disabled();
+        CPU::int_disable();
+        *cpu = Machine::cpu_id();
+        return was_locked;
+    }
+    void _heap_cache_unlock(bool was_locked) {
+        if(!was_locked)
+            CPU::int_enable();
     }
 }
@@ -0,0 +1,381 @@
+/*=======================================================================*/
+/* epostrace.cc                                                          */
+/*                                                                       */
+/* Desc: Tool to decode and analyze EPOS DVFS traces (see trace.h).      */
+/*       Reads either a console log containing the output of            */
+/*       Trace::dump() or a raw image of trace records, writes one CSV  */
+/*       time series per CPU and prints summary statistics.             */
+/*                                                                       */
+/* Parm: [-b] [-f <TSC frequency>] [-o <prefix>] <trace file | ->        */
+/*=======================================================================*/
+
+// Using only bare C, since tools are linked without libstdc++
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// CONSTANTS
+static const unsigned int VERSION = 1;
+static const unsigned int MAX_CPUS = 256;
+static const unsigned int LINE_MAX_LEN = 1024;
+
+// TYPES
+
+// Must match Trace::Record (little endian, packed)
+struct Record
+{
+    unsigned long long time_stamp;
+    unsigned int instructions;
+    unsigned int cycles;
+    unsigned int llc_misses;
+    unsigned int clock;
+    unsigned int thread;
+    unsigned char ready;
+    unsigned char temperature;
+    unsigned char event;
+    unsigned char cpu;
+} __attribute__((packed));
+
+enum Event {
+    SAMPLE = 1,
+    DISPATCH,
+    CLOCK,
+    MIGRATION,
+    USER
+};
+
+struct Statistics
+{
+    unsigned int records;
+    unsigned int events[USER + 1];
+    unsigned long long first;
+    unsigned long long last;
+    unsigned int min_temperature;
+    unsigned int max_temperature;
+    double temperature;                 // time-weighted sums
+    double clock;
+    double ready;
+    unsigned long long instructions;    // counter deltas
+    unsigned long long cycles;
+    unsigned long long llc_misses;
+};
+
+// GLOBALS
+static Record * records;
+static unsigned int n_records;
+static unsigned int max_records;
+static unsigned long long tsc_frequency;
+static unsigned int lost[MAX_CPUS];
+
+// PROTOTYPES
+static void usage(const char * name);
+static void append(const Record & record);
+static int read_text(FILE * in);
+static int read_binary(FILE * in);
+static int decode(const char * text, unsigned char * data, unsigned int size);
+static int compare(const void * a, const void * b);
+static const char * event_name(unsigned int event);
+static double seconds(unsigned long long ticks);
+static int analyze(const char * prefix);
+
+//=============================================================================
+// MAIN
+//=============================================================================
+int main(int argc, char ** argv)
+{
+    bool binary = false;
+    const char * prefix = "trace_";
+
+    int opt;
+    while((opt = getopt(argc, argv, "bf:o:")) != -1) {
+        switch(opt) {
+        case 'b': binary = true; break;
+        case 'f': tsc_frequency = strtoull(optarg, 0, 0); break;
+        case 'o': prefix = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if(optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE * in = strcmp(argv[optind], "-") ? fopen(argv[optind], binary ? "rb" : "r") : stdin;
+    if(!in) {
+        fprintf(stderr, "Error: can't open \"%s\"!\n", argv[optind]);
+        return 1;
+    }
+
+    int status = binary ? read_binary(in) : read_text(in);
+    if(in != stdin)
+        fclose(in);
+    if(status)
+        return status;
+
+    if(!n_records) {
+        fprintf(stderr, "Error: no trace records found!\n");
+        return 1;
+    }
+
+    status = analyze(prefix);
+
+    free(records);
+
+    return status;
+}
+
+//=============================================================================
+// USAGE
+//=============================================================================
+static void usage(const char * name)
+{
+    fprintf(stderr, "Usage: %s [-b] [-f <TSC frequency>] [-o <prefix>] <trace file | ->\n", name);
+    fprintf(stderr, "  -b  input is a raw image of trace records instead of a console log\n");
+    fprintf(stderr, "  -f  TSC frequency in Hz (taken from the \"#H\" line of console logs)\n");
+    fprintf(stderr, "  -o  prefix of the per-CPU CSV files (default \"trace_\")\n");
+}
+
+//=============================================================================
+// APPEND
+//=============================================================================
+static void append(const Record & record)
+{
+    if(n_records == max_records) {
+        max_records = max_records ? max_records * 2 : 4096;
+        records = static_cast<Record *>(realloc(records, max_records * sizeof(Record)));
+        if(!records) {
+            fprintf(stderr, "Error: out of memory!\n");
+            exit(1);
+        }
+    }
+    records[n_records++] = record;
+}
+
+//=============================================================================
+// READ_TEXT
+//=============================================================================
+// Console lines might carry other output, such as OStream's multicore tags, around the trace
+static int read_text(FILE * in)
+{
+    char line[LINE_MAX_LEN];
+    unsigned int line_number = 0;
+
+    while(fgets(line, sizeof(line), in)) {
+        line_number++;
+
+        char * p;
+        if((p = strstr(line, "#H "))) {
+            unsigned int version, cpus, size;
+            unsigned long long frequency;
+            if(sscanf(p + 3, "%u %llu %u %u", &version, &frequency, &cpus, &size) != 4) {
+                fprintf(stderr, "Warning: malformed header at line %u!\n", line_number);
+                continue;
+            }
+            if((version != VERSION) || (size != sizeof(Record))) {
+                fprintf(stderr, "Error: unsupported trace version %u with records of %u bytes at line %u!\n", version, size, line_number);
+                return 1;
+            }
+            if(!tsc_frequency)
+                tsc_frequency = frequency;
+        } else if((p = strstr(line, "#T "))) {
+            Record record;
+            if(decode(p + 3, reinterpret_cast<unsigned char *>(&record), sizeof(Record)))
+                fprintf(stderr, "Warning: corrupted record at line %u!\n", line_number);
+            else
+                append(record);
+        } else if((p = strstr(line, "#L "))) {
+            unsigned int cpu, n;
+            if((sscanf(p + 3, "%u %u", &cpu, &n) == 2) && (cpu < MAX_CPUS))
+                lost[cpu] = n;
+        }
+    }
+
+    return 0;
+}
+
+//=============================================================================
+// READ_BINARY
+//=============================================================================
+// Raw images (e.g. dumped from the rings by a debugger) may hold unused slots, which are all zeros
+static int read_binary(FILE * in)
+{
+    Record record;
+
+    while(fread(&record, sizeof(Record), 1, in) == 1)
+        if(record.event && record.time_stamp)
+            append(record);
+
+    return 0;
+}
+
+//=============================================================================
+// DECODE
+//=============================================================================
+// Base64 (RFC 4648)
+static int decode(const char * text, unsigned char * data, unsigned int size)
+{
+    unsigned int n = 0;
+    unsigned int group = 0;
+    unsigned int bits = 0;
+
+    for(; *text && (*text != '=') && (*text != ' ') && (*text != '\n') && (*text != '\r'); text++) {
+        const char c = *text;
+        unsigned int v;
+        if((c >= 'A') && (c <= 'Z'))
+            v = c - 'A';
+        else if((c >= 'a') && (c <= 'z'))
+            v = c - 'a' + 26;
+        else if((c >= '0') && (c <= '9'))
+            v = c - '0' + 52;
+        else if(c == '+')
+            v = 62;
+        else if(c == '/')
+            v = 63;
+        else
+            return -1;
+
+        group = (group << 6) | v;
+        bits += 6;
+        if(bits >= 8) {
+            bits -= 8;
+            if(n == size)
+                return -1;
+            data[n++] = (group >> bits) & 0xff;
+        }
+    }
+
+    return (n == size) ? 0 : -1;
+}
+
+//=============================================================================
+// COMPARE
+//=============================================================================
+// By CPU, then by time (rings in OVERWRITE mode wrap around)
+static int compare(const void * a, const void * b)
+{
+    const Record * r1 = static_cast<const Record *>(a);
+    const Record * r2 = static_cast<const Record *>(b);
+
+    if(r1->cpu != r2->cpu)
+        return (r1->cpu < r2->cpu) ? -1 : 1;
+    if(r1->time_stamp != r2->time_stamp)
+        return (r1->time_stamp < r2->time_stamp) ? -1 : 1;
+    return 0;
+}
+
+//=============================================================================
+// EVENT_NAME
+//=============================================================================
+static const char * event_name(unsigned int event)
+{
+    switch(event) {
+    case SAMPLE:    return "sample";
+    case DISPATCH:  return "dispatch";
+    case CLOCK:     return "clock";
+    case MIGRATION: return "migration";
+    case USER:      return "user";
+    default:        return "unknown";
+    }
+}
+
+//=============================================================================
+// SECONDS
+//=============================================================================
+// Without the TSC frequency, times are given in TSC ticks
+static double seconds(unsigned long long ticks)
+{
+    return tsc_frequency ? static_cast<double>(ticks) / tsc_frequency : static_cast<double>(ticks);
+}
+
+//=============================================================================
+// ANALYZE
+//=============================================================================
+static int analyze(const char * prefix)
+{
+    qsort(records, n_records, sizeof(Record), compare);
+
+    unsigned long long origin = records[0].time_stamp;
+    for(unsigned int i = 1; i < n_records; i++)
+        if(records[i].time_stamp < origin)
+            origin = records[i].time_stamp;
+
+    if(!tsc_frequency)
+        fprintf(stderr, "Warning: unknown TSC frequency, times are given in TSC ticks!\n");
+
+    printf("%4s %8s %8s %10s %5s %5s %5s %9s %6s %12s %7s %6s %10s %6s %10s\n",
+           "CPU", "records", "lost", "duration", "Tmin", "Tavg", "Tmax", "clock", "IPC", "LLC misses", "MPKI", "ready", "dispatches", "clocks", "migrations");
+
+    for(unsigned int begin = 0, end; begin < n_records; begin = end) {
+        unsigned int cpu = records[begin].cpu;
+        for(end = begin; (end < n_records) && (records[end].cpu == cpu); end++);
+
+        char file_name[LINE_MAX_LEN];
+        snprintf(file_name, sizeof(file_name), "%scpu%u.csv", prefix, cpu);
+        FILE * out = fopen(file_name, "w");
+        if(!out) {
+            fprintf(stderr, "Error: can't create \"%s\"!\n", file_name);
+            return 1;
+        }
+        fprintf(out, "time,event,thread,temperature,clock_mhz,ipc,llc_misses,ready\n");
+
+        Statistics stats;
+        memset(&stats, 0, sizeof(stats));
+        stats.first = records[begin].time_stamp;
+        stats.last = records[end - 1].time_stamp;
+        stats.min_temperature = 255;
+
+        for(unsigned int i = begin; i < end; i++) {
+            const Record & r = records[i];
+
+            stats.records++;
+            if(r.event <= USER)
+                stats.events[r.event]++;
+            if(r.temperature < stats.min_temperature)
+                stats.min_temperature = r.temperature;
+            if(r.temperature > stats.max_temperature)
+                stats.max_temperature = r.temperature;
+
+            fprintf(out, "%.9f,%s,%#x,%u,%.3f,", seconds(r.time_stamp - origin), event_name(r.event), r.thread, r.temperature, r.clock / 1e6);
+
+            if(i == begin) {
+                fprintf(out, ",,%u\n", r.ready);
+                continue;
+            }
+
+            // Counters are 32 bits wide and wrap around, so deltas are taken modulo 2^32
+            const Record & p = records[i - 1];
+            unsigned int instructions = r.instructions - p.instructions;
+            unsigned int cycles = r.cycles - p.cycles;
+            unsigned int llc_misses = r.llc_misses - p.llc_misses;
+            double dt = static_cast<double>(r.time_stamp - p.time_stamp);
+
+            stats.instructions += instructions;
+            stats.cycles += cycles;
+            stats.llc_misses += llc_misses;
+            stats.temperature += p.temperature * dt;
+            stats.clock += p.clock * dt;
+            stats.ready += p.ready * dt;
+
+            if(cycles)
+                fprintf(out, "%.3f", static_cast<double>(instructions) / cycles);
+            fprintf(out, ",%u,%u\n", llc_misses, r.ready);
+        }
+
+        fclose(out);
+
+        double duration = static_cast<double>(stats.last - stats.first);
+        double weight = duration ? duration : 1;
+        printf("%4u %8u %8u %10.3f %5u %5.1f %5u %9.1f %6.3f %12llu %7.3f %6.2f %10u %6u %10u\n",
+               cpu, stats.records, lost[cpu], seconds(stats.last - stats.first),
+               stats.min_temperature, stats.temperature / weight, stats.max_temperature,
+               stats.clock / weight / 1e6,
+               stats.cycles ? static_cast<double>(stats.instructions) / stats.cycles : 0.0,
+               stats.llc_misses,
+               stats.instructions ? 1000.0 * stats.llc_misses / stats.instructions : 0.0,
+               stats.ready / weight,
+               stats.events[DISPATCH], stats.events[CLOCK], stats.events[MIGRATION]);
+    }
+
+    return 0;
+}